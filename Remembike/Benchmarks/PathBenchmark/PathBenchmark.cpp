@@ -0,0 +1,102 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+// Standalone micro-benchmark of the street graph pathfinding in Source/GameJam2021/RouteCore.
+//
+// Build and run from this directory on Linux:
+//   g++ -std=c++14 -O2 -I../../Source/GameJam2021 PathBenchmark.cpp ../../Source/GameJam2021/RouteCore/*.cpp -o PathBenchmark
+//   ./PathBenchmark [queries per case]
+//
+// For every grid size it reports the graph build time, the graph and field memory, p50/p99 latency and expanded states of an A* query
+// between random states and building sides, the time to build the flow field toward one building side, the p50/p99
+// latency of reading a path off that field, and how many field paths were not as short as the A* ones (should be 0).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "RouteCore/StreetPathfinder.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double ToNanoseconds(const Clock::duration inDuration)
+	{
+		return std::chrono::duration<double, std::nano>(inDuration).count();
+	}
+
+	RouteCore::FRouteState GetRandomState(RouteCore::FRouteRandom& ioRandom, const int inGridSize)
+	{
+		RouteCore::FRouteState state;
+		state.mGridPosition = RouteCore::FGridPosition(ioRandom.NextInt(inGridSize), ioRandom.NextInt(inGridSize));
+		state.mFacingDirection = static_cast<RouteCore::EDirection>(ioRandom.NextInt(RouteCore::NumDirections));
+		state.mBuildingSide = static_cast<RouteCore::EDirection>(ioRandom.NextInt(RouteCore::NumDirections));
+		return state;
+	}
+
+	double GetPercentile(std::vector<double>& ioSamples, const int inPercent)
+	{
+		std::sort(ioSamples.begin(), ioSamples.end());
+		return ioSamples[std::min(ioSamples.size() - 1, (ioSamples.size() * inPercent) / 100)];
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int num_queries = (argc > 1 ? std::max(1, std::atoi(argv[1])) : 20000);
+	const int grid_sizes[] = { 6, 16, 64, 256 };
+
+	std::printf("%-6s %10s %10s %10s %10s %10s %12s %10s %10s %10s\n",
+		"grid", "graph ms", "mem MB", "A* p50 ns", "A* p99 ns", "expanded", "field ms", "path p50", "path p99", "longer");
+	for (const int grid_size : grid_sizes)
+	{
+		const Clock::time_point graph_start = Clock::now();
+		const RouteCore::FStreetGraph graph(grid_size);
+		const double graph_ms = ToNanoseconds(Clock::now() - graph_start) * 1e-6;
+
+		RouteCore::FRouteRandom random(12345u);
+		const RouteCore::FGridPosition goal_cell(grid_size / 2, grid_size / 2);
+		const RouteCore::EDirection goal_side = RouteCore::EDirection::RIGHT;
+
+		// Every query goes to the same building side, like agents heading to the current delivery
+		std::vector<RouteCore::FRouteState> start_states(num_queries);
+		for (RouteCore::FRouteState& start_state : start_states)
+			start_state = GetRandomState(random, grid_size);
+
+		RouteCore::FStreetPathfinder pathfinder(graph);
+		RouteCore::FStreetPath path;
+		std::vector<double> astar_latencies(num_queries);
+		std::vector<int> astar_lengths(num_queries, -1);
+		long long num_expanded_states = 0;
+		for (int query_i = 0; query_i < num_queries; ++query_i)
+		{
+			const Clock::time_point query_start = Clock::now();
+			if (pathfinder.FindPath(start_states[query_i], goal_cell, goal_side, path))
+				astar_lengths[query_i] = static_cast<int>(path.mDirections.size());
+			astar_latencies[query_i] = ToNanoseconds(Clock::now() - query_start);
+			num_expanded_states += pathfinder.GetNumExpandedStates();
+		}
+
+		RouteCore::FStreetFlowField flow_field;
+		const Clock::time_point field_start = Clock::now();
+		flow_field.Build(graph, goal_cell, goal_side);
+		const double field_ms = ToNanoseconds(Clock::now() - field_start) * 1e-6;
+
+		std::vector<double> path_latencies(num_queries);
+		int num_longer_paths = 0;
+		for (int query_i = 0; query_i < num_queries; ++query_i)
+		{
+			const Clock::time_point query_start = Clock::now();
+			const bool found = flow_field.GetPath(graph, start_states[query_i], path);
+			path_latencies[query_i] = ToNanoseconds(Clock::now() - query_start);
+			if ((found ? static_cast<int>(path.mDirections.size()) : -1) != astar_lengths[query_i])
+				++num_longer_paths;
+		}
+
+		std::printf("%-6d %10.3f %10.2f %10.0f %10.0f %10.1f %12.3f %10.0f %10.0f %10d\n", grid_size, graph_ms,
+			(graph.GetAllocatedBytes() + flow_field.GetAllocatedBytes()) / (1024.0 * 1024.0), GetPercentile(astar_latencies, 50), GetPercentile(astar_latencies, 99),
+			static_cast<double>(num_expanded_states) / num_queries, field_ms, GetPercentile(path_latencies, 50), GetPercentile(path_latencies, 99), num_longer_paths);
+	}
+	return 0;
+}
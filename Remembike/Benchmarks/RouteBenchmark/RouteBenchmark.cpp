@@ -0,0 +1,117 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+// Standalone micro-benchmark of the engine-independent route generation in Source/GameJam2021/RouteCore.
+//
+// Build and run from this directory on Linux:
+//   g++ -std=c++14 -O2 -I../../Source/GameJam2021 RouteBenchmark.cpp ../../Source/GameJam2021/RouteCore/*.cpp -o RouteBenchmark
+//   ./RouteBenchmark [routes per case]
+//
+// For every grid size and route length it reports routes/second, p50/p99 latency of a single
+// GenerateRoute call, how many routes came out shorter than asked because no endpoint was that far, how many calls
+// had to fall back and how many heap allocations happened while generating.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "RouteCore/RouteGenerator.h"
+
+namespace
+{
+	std::atomic<long long> gNumAllocations(0);
+}
+
+void* operator new(std::size_t inSize)
+{
+	++gNumAllocations;
+	if (void* ptr = std::malloc(inSize != 0 ? inSize : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* inPtr) noexcept
+{
+	std::free(inPtr);
+}
+
+void operator delete(void* inPtr, std::size_t) noexcept
+{
+	std::free(inPtr);
+}
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct FCaseResult
+	{
+		double mRoutesPerSecond = 0.0;
+		double mP50Nanoseconds = 0.0;
+		double mP99Nanoseconds = 0.0;
+		long long mNumShortRoutes = 0;
+		long long mNumFallbacks = 0;
+		long long mNumAllocations = 0;
+	};
+
+	FCaseResult RunCase(const int inGridSize, const int inRouteLength, const int inNumRoutes, std::vector<double>& ioLatencies)
+	{
+		RouteCore::FRouteGenerator generator(inGridSize, 12345u);
+		RouteCore::FDeliveryRoute route;
+		RouteCore::FRouteState start_state;
+		start_state.mFacingDirection = RouteCore::EDirection::FORWARD;
+		start_state.mBuildingSide = RouteCore::EDirection::RIGHT;
+		start_state.mGridPosition = RouteCore::FGridPosition(inGridSize / 2, inGridSize / 2);
+
+		FCaseResult result;
+		ioLatencies.resize(inNumRoutes);
+
+		const long long allocations_before = gNumAllocations.load();
+		const Clock::time_point case_start = Clock::now();
+		for (int route_i = 0; route_i < inNumRoutes; ++route_i)
+		{
+			const Clock::time_point route_start = Clock::now();
+			if (!generator.GenerateRoute(start_state, inRouteLength, route))
+				++result.mNumFallbacks;
+			else if (route.mNumDirections < inRouteLength)
+				++result.mNumShortRoutes;
+			const Clock::time_point route_end = Clock::now();
+			ioLatencies[route_i] = std::chrono::duration<double, std::nano>(route_end - route_start).count();
+
+			// Chain deliveries the way the game does, starting where the previous one ended
+			start_state = route.mEndState;
+		}
+		const double case_seconds = std::chrono::duration<double>(Clock::now() - case_start).count();
+		result.mNumAllocations = gNumAllocations.load() - allocations_before;
+
+		std::sort(ioLatencies.begin(), ioLatencies.end());
+		result.mRoutesPerSecond = inNumRoutes / case_seconds;
+		result.mP50Nanoseconds = ioLatencies[inNumRoutes / 2];
+		result.mP99Nanoseconds = ioLatencies[std::min(inNumRoutes - 1, (inNumRoutes * 99) / 100)];
+		return result;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int num_routes = (argc > 1 ? std::max(1, std::atoi(argv[1])) : 200000);
+	const int grid_sizes[] = { 6, 16, 64, 256 };
+	const int route_lengths[] = { 2, 4, 6, 10, 16 };
+
+	std::vector<double> latencies;
+	latencies.reserve(num_routes);
+
+	std::printf("%-6s %-7s %14s %10s %10s %10s %10s %12s\n", "grid", "length", "routes/s", "p50 ns", "p99 ns", "short", "fallbacks", "allocations");
+	for (const int grid_size : grid_sizes)
+	{
+		for (const int route_length : route_lengths)
+		{
+			const FCaseResult result = RunCase(grid_size, route_length, num_routes, latencies);
+			std::printf("%-6d %-7d %14.0f %10.0f %10.0f %10lld %10lld %12lld\n", grid_size, route_length, result.mRoutesPerSecond,
+				result.mP50Nanoseconds, result.mP99Nanoseconds, result.mNumShortRoutes, result.mNumFallbacks, result.mNumAllocations);
+		}
+	}
+	return 0;
+}
@@ -1,13 +1,16 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-using UnrealBuildTool;
-
-public class GameJam2021 : ModuleRules
-{
-	public GameJam2021(ReadOnlyTargetRules Target) : base(Target)
-	{
-		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
-
-        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "NavigationSystem", "AIModule" });
-    }
-}
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class GameJam2021 : ModuleRules
+{
+	public GameJam2021(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "NavigationSystem", "AIModule", "Paper2D" });
+
+		// Route event tracing is only compiled into non-Shipping builds
+		PublicDefinitions.Add(Target.Configuration == UnrealTargetConfiguration.Shipping ? "REMEMBIKE_ROUTE_TRACE=0" : "REMEMBIKE_ROUTE_TRACE=1");
+    }
+}
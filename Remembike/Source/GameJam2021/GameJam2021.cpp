@@ -1,9 +1,47 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#include "GameJam2021.h"
-#include "Modules/ModuleManager.h"
-
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, GameJam2021, "GameJam2021" );
-
-DEFINE_LOG_CATEGORY(LogGameJam2021)
- 
\ No newline at end of file
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021.h"
+#include "Modules/ModuleManager.h"
+#include "UObject/UObjectGlobals.h"
+#include "Engine/World.h"
+
+// Logs how long every map takes to load and the physical memory used once it is loaded
+class FGameJam2021Module : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		FCoreUObjectDelegates::PreLoadMap.AddRaw(this, &FGameJam2021Module::OnPreLoadMap);
+		FCoreUObjectDelegates::PostLoadMapWithWorld.AddRaw(this, &FGameJam2021Module::OnPostLoadMap);
+	}
+
+	virtual void ShutdownModule() override
+	{
+		FCoreUObjectDelegates::PreLoadMap.RemoveAll(this);
+		FCoreUObjectDelegates::PostLoadMapWithWorld.RemoveAll(this);
+	}
+
+private:
+	void OnPreLoadMap(const FString& inMapName)
+	{
+		mLoadMapStartSeconds = FPlatformTime::Seconds();
+	}
+
+	void OnPostLoadMap(UWorld* inWorld)
+	{
+		if (mLoadMapStartSeconds == 0.0)
+			return;
+
+		UE_LOG(LogRemembike, Display, TEXT("Map %s loaded in %.3f ms, %.1f MB of physical memory used"),
+			inWorld ? *inWorld->GetMapName() : TEXT("None"), (FPlatformTime::Seconds() - mLoadMapStartSeconds) * 1000.0,
+			FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0));
+		mLoadMapStartSeconds = 0.0;
+	}
+
+	double mLoadMapStartSeconds = 0.0;
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FGameJam2021Module, GameJam2021, "GameJam2021" );
+
+DEFINE_LOG_CATEGORY(LogGameJam2021)
+DEFINE_LOG_CATEGORY(LogRemembike)
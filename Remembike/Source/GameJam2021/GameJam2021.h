@@ -1,7 +1,14 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-
-DECLARE_LOG_CATEGORY_EXTERN(LogGameJam2021, Log, All);
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogGameJam2021, Log, All);
+
+// Gameplay logging, everything below Warning is stripped at compile time in Shipping
+#if UE_BUILD_SHIPPING
+DECLARE_LOG_CATEGORY_EXTERN(LogRemembike, Log, Warning);
+#else
+DECLARE_LOG_CATEGORY_EXTERN(LogRemembike, Log, All);
+#endif
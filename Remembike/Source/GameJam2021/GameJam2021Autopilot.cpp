@@ -0,0 +1,106 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021Autopilot.h"
+#include "GameJam2021.h"
+#include "GameJam2021InputRecording.h"
+#include "HAL/PlatformMemory.h"
+
+void FGameJam2021Autopilot::Initialize(const FSettings& inSettings)
+{
+	mSettings = inSettings;
+	SetWaypoints(TArray<FVector>());
+	mFrameTimes.Reset();
+	mFrameTimes.Reserve(FMath::CeilToInt(mSettings.mReportSeconds * 120.0f));
+	mElapsedSeconds = 0.0;
+	mSecondsSinceReport = 0.0f;
+	mInitialUsedPhysicalMemory = FPlatformMemory::GetStats().UsedPhysical;
+	mNumDeliveries = 0;
+	mNumStuck = 0;
+	mNumFailedRoutes = 0;
+	mNumTimeouts = 0;
+}
+
+void FGameJam2021Autopilot::SetWaypoints(const TArray<FVector>& inWaypoints)
+{
+	mWaypoints = inWaypoints;
+	mCurrentWaypoint = 0;
+	mClosestDistance = MAX_flt;
+	mSecondsWithoutProgress = 0.0f;
+}
+
+uint8 FGameJam2021Autopilot::Update(const FVector& inLocation, const float inYaw, const float inDeltaTime, bool& outIsStuck)
+{
+	outIsStuck = false;
+
+	// Waypoints reached in this frame are skipped at once, several of them can share a position
+	while (mWaypoints.IsValidIndex(mCurrentWaypoint) && FVector::DistXY(inLocation, mWaypoints[mCurrentWaypoint]) < mSettings.mWaypointRadius)
+	{
+		++mCurrentWaypoint;
+		mClosestDistance = MAX_flt;
+		mSecondsWithoutProgress = 0.0f;
+	}
+
+	if (!mWaypoints.IsValidIndex(mCurrentWaypoint))
+		return 0;
+
+	const FVector to_waypoint = mWaypoints[mCurrentWaypoint] - inLocation;
+	const float distance = to_waypoint.Size2D();
+	if (distance < mClosestDistance - 1.0f)
+	{
+		mClosestDistance = distance;
+		mSecondsWithoutProgress = 0.0f;
+	}
+	else
+	{
+		mSecondsWithoutProgress += inDeltaTime;
+		if (mSecondsWithoutProgress >= mSettings.mStuckSeconds)
+		{
+			++mNumStuck;
+			UE_LOG(LogRemembike, Warning, TEXT("Autopilot stuck at %s on the way to waypoint %d of %d at %s"),
+				*inLocation.ToString(), mCurrentWaypoint, mWaypoints.Num(), *mWaypoints[mCurrentWaypoint].ToString());
+			mClosestDistance = MAX_flt;
+			mSecondsWithoutProgress = 0.0f;
+			outIsStuck = true;
+		}
+	}
+
+	const float waypoint_yaw = FMath::RadiansToDegrees(FMath::Atan2(to_waypoint.Y, to_waypoint.X));
+	const float delta_yaw = FMath::FindDeltaAngleDegrees(inYaw, waypoint_yaw);
+
+	uint8 input_bits = 0;
+	if (delta_yaw > mSettings.mTurnDeadZoneAngle)
+		input_bits |= FGameJam2021InputRecording::TurnRightBit;
+	else if (delta_yaw < -mSettings.mTurnDeadZoneAngle)
+		input_bits |= FGameJam2021InputRecording::TurnLeftBit;
+	if (FMath::Abs(delta_yaw) < mSettings.mAlignedAngle)
+		input_bits |= FGameJam2021InputRecording::GoForwardBit;
+	return input_bits;
+}
+
+void FGameJam2021Autopilot::RecordFrame(const float inDeltaTime)
+{
+	mFrameTimes.Add(inDeltaTime);
+	mElapsedSeconds += inDeltaTime;
+	mSecondsSinceReport += inDeltaTime;
+	if (mSecondsSinceReport >= mSettings.mReportSeconds)
+		Report();
+}
+
+void FGameJam2021Autopilot::Report()
+{
+	mFrameTimes.Sort();
+	const auto get_percentile_ms = [this](const int inPercentile)
+	{
+		return mFrameTimes.Num() > 0 ? mFrameTimes[FMath::Min(mFrameTimes.Num() * inPercentile / 100, mFrameTimes.Num() - 1)] * 1000.0f : 0.0f;
+	};
+
+	const int64 memory_growth = static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical) - static_cast<int64>(mInitialUsedPhysicalMemory);
+	UE_LOG(LogRemembike, Display, TEXT("Autopilot after %.0f s: %d deliveries (%.2f per minute), %d stuck, %d failed routes, %d timeouts. ")
+		TEXT("Frame time p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms. Used physical memory grew by %.2f MiB"),
+		mElapsedSeconds, mNumDeliveries, mElapsedSeconds > 0.0 ? mNumDeliveries * 60.0 / mElapsedSeconds : 0.0, mNumStuck, mNumFailedRoutes, mNumTimeouts,
+		get_percentile_ms(50), get_percentile_ms(95), get_percentile_ms(99), get_percentile_ms(100),
+		memory_growth / (1024.0 * 1024.0));
+
+	mFrameTimes.Reset();
+	mSecondsSinceReport = 0.0f;
+}
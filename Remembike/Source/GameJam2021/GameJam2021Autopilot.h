@@ -0,0 +1,55 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Rides the bike along the waypoints of the current delivery route by producing the same input bits a player's
+// key presses would (see FGameJam2021InputRecording::EInputBits), and keeps the soak test numbers of long runs.
+class FGameJam2021Autopilot
+{
+public:
+	struct FSettings
+	{
+		float mWaypointRadius = 20.0f;
+		float mAlignedAngle = 45.0f; // Only rides forward when facing the waypoint within this angle
+		float mTurnDeadZoneAngle = 5.0f;
+		float mStuckSeconds = 3.0f; // Without getting closer to the waypoint
+		float mReportSeconds = 60.0f;
+	};
+
+	void Initialize(const FSettings& inSettings);
+	const FSettings& GetSettings() const { return mSettings; }
+
+	void SetWaypoints(const TArray<FVector>& inWaypoints);
+	const FVector* GetCurrentWaypoint() const { return mWaypoints.IsValidIndex(mCurrentWaypoint) ? &mWaypoints[mCurrentWaypoint] : nullptr; }
+
+	// Input bits to apply this frame. outIsStuck is set once when no progress was made for mStuckSeconds.
+	uint8 Update(const FVector& inLocation, const float inYaw, const float inDeltaTime, bool& outIsStuck);
+
+	void RecordFrame(const float inDeltaTime);
+	void RecordDelivery() { ++mNumDeliveries; }
+	void RecordFailedRoute() { ++mNumFailedRoutes; }
+	void RecordTimeout() { ++mNumTimeouts; }
+	int GetNumDeliveries() const { return mNumDeliveries; }
+
+	// Logs deliveries per minute, frame time percentiles and memory growth since Initialize
+	void Report();
+
+private:
+	FSettings mSettings;
+
+	TArray<FVector> mWaypoints;
+	int mCurrentWaypoint = 0;
+	float mClosestDistance = 0.0f;
+	float mSecondsWithoutProgress = 0.0f;
+
+	TArray<float> mFrameTimes; // Since the last report
+	double mElapsedSeconds = 0.0;
+	float mSecondsSinceReport = 0.0f;
+	uint64 mInitialUsedPhysicalMemory = 0;
+	int mNumDeliveries = 0;
+	int mNumStuck = 0;
+	int mNumFailedRoutes = 0;
+	int mNumTimeouts = 0;
+};
@@ -0,0 +1,123 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021BikeMovementComponent.h"
+#include "GameJam2021Stats.h"
+
+UGameJam2021BikeMovementComponent::UGameJam2021BikeMovementComponent()
+{
+	bConstrainToPlane = true;
+	SetPlaneConstraintNormal(FVector::UpVector);
+}
+
+void UGameJam2021BikeMovementComponent::TickComponent(float inDeltaTime, enum ELevelTick inTickType, FActorComponentTickFunction* inThisTickFunction)
+{
+	Super::TickComponent(inDeltaTime, inTickType, inThisTickFunction);
+
+	if (!PawnOwner || !UpdatedComponent || ShouldSkipUpdate(inDeltaTime) || inDeltaTime <= 0.0f)
+		return;
+
+	SCOPE_CYCLE_COUNTER(STAT_RemembikeBikeMovement);
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameJam2021BikeMovementComponent::TickComponent);
+
+	// Throttle is the input along the bike, any sideways input is ignored like a bike would
+	const FVector forward = UpdatedComponent->GetForwardVector();
+	const float throttle = FVector::DotProduct(ConsumeInputVector().GetClampedToMaxSize(1.0f), forward);
+	if (FMath::Abs(throttle) > KINDA_SMALL_NUMBER)
+		mSpeed = FMath::Clamp(mSpeed + throttle * mAcceleration * inDeltaTime, -mMaxSpeed, mMaxSpeed);
+	else
+		mSpeed = (mSpeed > 0.0f ? FMath::Max(mSpeed - mBraking * inDeltaTime, 0.0f) : FMath::Min(mSpeed + mBraking * inDeltaTime, 0.0f));
+
+	const FVector location = UpdatedComponent->GetComponentLocation();
+	const FVector2D forward_2d(forward);
+	FVector2D position = FVector2D(location) + forward_2d * (mSpeed * inDeltaTime);
+	FVector2D hit_normal;
+	const bool is_barrier_hit = ResolveCollisions(position, hit_normal);
+
+	// Sliding along a wall keeps only the part of the speed that is not into it
+	if (!hit_normal.IsZero())
+		mSpeed *= 1.0f - FMath::Abs(FVector2D::DotProduct(forward_2d, hit_normal));
+	if (is_barrier_hit)
+		mSpeed = 0.0f;
+
+	const FVector new_location(position, location.Z);
+	Velocity = (new_location - location) / inDeltaTime;
+	UpdatedComponent->SetWorldLocation(new_location);
+	UpdateComponentVelocity();
+
+	if (is_barrier_hit)
+		mOnBarrierHit.Broadcast();
+}
+
+bool UGameJam2021BikeMovementComponent::ResolveCollisions(FVector2D& ioPosition, FVector2D& outHitNormal) const
+{
+	outHitNormal = FVector2D::ZeroVector;
+	const float building_extent = mLayout.mBuildingSize * mBuildingExtent;
+
+	// Only the buildings around the cell the bike is in can touch it
+	RouteCore::FWorldPosition world_position;
+	world_position.X = ioPosition.X;
+	world_position.Y = ioPosition.Y;
+	const RouteCore::FGridPosition cell = mLayout.GetGridPosition(world_position);
+	for (int y = cell.Y - 1; y <= cell.Y + 1; ++y)
+	{
+		for (int x = cell.X - 1; x <= cell.X + 1; ++x)
+		{
+			const RouteCore::FGridPosition building_cell(x, y);
+			if (!mLayout.IsInside(building_cell))
+				continue;
+
+			const RouteCore::FWorldPosition building_center = mLayout.GetGridWorldPosition(building_cell);
+			PushOutOfBox(FVector2D(building_center.X, building_center.Y), building_extent, ioPosition, outHitNormal);
+		}
+	}
+
+	// The barriers stand on the ring of cells around the city, as thick as a building
+	const RouteCore::FWorldPosition min_barrier = mLayout.GetGridWorldPosition(RouteCore::FGridPosition(-1, -1));
+	const RouteCore::FWorldPosition max_barrier = mLayout.GetGridWorldPosition(RouteCore::FGridPosition(mLayout.mGridSize, mLayout.mGridSize));
+	const FVector2D min_position(FMath::Min(min_barrier.X, max_barrier.X), FMath::Min(min_barrier.Y, max_barrier.Y));
+	const FVector2D max_position(FMath::Max(min_barrier.X, max_barrier.X), FMath::Max(min_barrier.Y, max_barrier.Y));
+	const float barrier_distance = building_extent + mBikeRadius;
+
+	bool is_barrier_hit = false;
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		const float min_coordinate = min_position[axis] + barrier_distance;
+		const float max_coordinate = max_position[axis] - barrier_distance;
+		if (ioPosition[axis] < min_coordinate)
+		{
+			ioPosition[axis] = min_coordinate;
+			outHitNormal = (axis == 0 ? FVector2D(1.0f, 0.0f) : FVector2D(0.0f, 1.0f));
+			is_barrier_hit = true;
+		}
+		else if (ioPosition[axis] > max_coordinate)
+		{
+			ioPosition[axis] = max_coordinate;
+			outHitNormal = (axis == 0 ? FVector2D(-1.0f, 0.0f) : FVector2D(0.0f, -1.0f));
+			is_barrier_hit = true;
+		}
+	}
+	return is_barrier_hit;
+}
+
+bool UGameJam2021BikeMovementComponent::PushOutOfBox(const FVector2D& inBoxCenter, const float inBoxExtent, FVector2D& ioPosition, FVector2D& outHitNormal) const
+{
+	const float extent = inBoxExtent + mBikeRadius;
+	const FVector2D offset = ioPosition - inBoxCenter;
+	const float penetration_x = extent - FMath::Abs(offset.X);
+	const float penetration_y = extent - FMath::Abs(offset.Y);
+	if (penetration_x <= 0.0f || penetration_y <= 0.0f)
+		return false;
+
+	// Out through the closest side
+	if (penetration_x < penetration_y)
+	{
+		outHitNormal = FVector2D(offset.X >= 0.0f ? 1.0f : -1.0f, 0.0f);
+		ioPosition.X += outHitNormal.X * penetration_x;
+	}
+	else
+	{
+		outHitNormal = FVector2D(0.0f, offset.Y >= 0.0f ? 1.0f : -1.0f);
+		ioPosition.Y += outHitNormal.Y * penetration_y;
+	}
+	return true;
+}
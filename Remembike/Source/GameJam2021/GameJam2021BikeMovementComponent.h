@@ -0,0 +1,59 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PawnMovementComponent.h"
+#include "RouteCore/CityGrid.h"
+#include "GameJam2021BikeMovementComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FGameJam2021OnBarrierHit);
+
+// Moves the bike analytically in the streets between the city blocks, instead of the walking, floor finding and
+// capsule sweeps of UCharacterMovementComponent. The bike only goes along its forward vector, with the pending
+// movement input as throttle. Buildings and the barriers around the city are axis aligned boxes the bike slides
+// along, and hitting a barrier broadcasts mOnBarrierHit.
+UCLASS(ClassGroup = Movement, meta = (BlueprintSpawnableComponent))
+class UGameJam2021BikeMovementComponent : public UPawnMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	UGameJam2021BikeMovementComponent();
+
+	UPROPERTY(EditAnywhere)
+	float mMaxSpeed = 600.0f;
+
+	UPROPERTY(EditAnywhere)
+	float mAcceleration = 2048.0f;
+
+	// Deceleration without throttle
+	UPROPERTY(EditAnywhere)
+	float mBraking = 2048.0f;
+
+	// Half the side of the box around the bike
+	UPROPERTY(EditAnywhere)
+	float mBikeRadius = 10.0f;
+
+	// Half the side of a building, as a fraction of the building size
+	UPROPERTY(EditAnywhere)
+	float mBuildingExtent = 0.3f;
+
+	UPROPERTY(BlueprintAssignable)
+	FGameJam2021OnBarrierHit mOnBarrierHit;
+
+	void SetCityLayout(const RouteCore::FCityLayout& inLayout) { mLayout = inLayout; }
+
+	// Keeps ioPosition out of the buildings and inside the barriers, returns whether it hit a barrier.
+	// outHitNormal is the direction the position was pushed in by the last box, zero when nothing was hit.
+	bool ResolveCollisions(FVector2D& ioPosition, FVector2D& outHitNormal) const;
+
+	virtual void TickComponent(float inDeltaTime, enum ELevelTick inTickType, FActorComponentTickFunction* inThisTickFunction) override;
+	virtual float GetMaxSpeed() const override { return mMaxSpeed; }
+
+private:
+	bool PushOutOfBox(const FVector2D& inBoxCenter, const float inBoxExtent, FVector2D& ioPosition, FVector2D& outHitNormal) const;
+
+	RouteCore::FCityLayout mLayout;
+	float mSpeed = 0.0f; // Along the forward vector
+};
@@ -0,0 +1,63 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021City.h"
+
+AGameJam2021City::AGameJam2021City()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	mBuildingInstances = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("BuildingInstances"));
+	mBuildingInstances->SetupAttachment(RootComponent);
+	mBuildingInstances->NumCustomDataFloats = 1;
+	mBuildingInstances->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+
+	mBarrierInstances = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("BarrierInstances"));
+	mBarrierInstances->SetupAttachment(RootComponent);
+	mBarrierInstances->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+}
+
+void AGameJam2021City::BuildInstances(const TArray<FTransform>& inBuildingTransforms, const TArray<int>& inBuildingLooks, const TArray<FTransform>& inBarrierTransforms)
+{
+	check(inBuildingTransforms.Num() == inBuildingLooks.Num());
+
+	ClearInstances();
+
+	TArray<FTransform> building_instance_transforms;
+	building_instance_transforms.Reserve(inBuildingTransforms.Num());
+	for (const FTransform& building_transform : inBuildingTransforms)
+		building_instance_transforms.Add(mBuildingMeshTransform * building_transform);
+
+	TArray<FTransform> barrier_instance_transforms;
+	barrier_instance_transforms.Reserve(inBarrierTransforms.Num());
+	for (const FTransform& barrier_transform : inBarrierTransforms)
+		barrier_instance_transforms.Add(mBarrierMeshTransform * barrier_transform);
+
+	// Added in one go so each tree is only built once
+	const TArray<int32> building_instance_indices = mBuildingInstances->AddInstances(building_instance_transforms, true);
+	for (int building_i = 0; building_i < building_instance_indices.Num(); ++building_i)
+	{
+		const float look = static_cast<float>(inBuildingLooks[building_i] % FMath::Max(mNumBuildingLooks, 1));
+		mBuildingInstances->SetCustomDataValue(building_instance_indices[building_i], 0, look, false);
+	}
+	mBuildingInstances->MarkRenderStateDirty();
+
+	mBarrierInstances->AddInstances(barrier_instance_transforms, false);
+}
+
+void AGameJam2021City::ClearInstances()
+{
+	mBuildingInstances->ClearInstances();
+	mBarrierInstances->ClearInstances();
+}
+
+int AGameJam2021City::GetNumBuildingInstances() const
+{
+	return mBuildingInstances->GetInstanceCount();
+}
+
+int AGameJam2021City::GetNumBarrierInstances() const
+{
+	return mBarrierInstances->GetInstanceCount();
+}
@@ -0,0 +1,44 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "GameJam2021City.generated.h"
+
+// Renders every building and boundary barrier of the city as hierarchical instanced static meshes, so the whole
+// city is two components sharing one collision body setup each instead of one actor per building and barrier.
+// Meshes and materials are set on the components of the Blueprint subclass. The building material reads its
+// look from PerInstanceCustomData[0], an index in [0, mNumBuildingLooks).
+UCLASS()
+class AGameJam2021City : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AGameJam2021City();
+
+	UPROPERTY(EditAnywhere)
+	int mNumBuildingLooks = 3;
+
+	// Transform of the meshes relative to the grid position they are placed at
+	UPROPERTY(EditAnywhere)
+	FTransform mBuildingMeshTransform;
+
+	UPROPERTY(EditAnywhere)
+	FTransform mBarrierMeshTransform;
+
+	void BuildInstances(const TArray<FTransform>& inBuildingTransforms, const TArray<int>& inBuildingLooks, const TArray<FTransform>& inBarrierTransforms);
+	void ClearInstances();
+
+	int GetNumBuildingInstances() const;
+	int GetNumBarrierInstances() const;
+
+protected:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UHierarchicalInstancedStaticMeshComponent* mBuildingInstances = nullptr;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UHierarchicalInstancedStaticMeshComponent* mBarrierInstances = nullptr;
+};
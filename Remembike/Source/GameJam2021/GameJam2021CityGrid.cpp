@@ -0,0 +1,395 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021CityGrid.h"
+#include <algorithm>
+#include <array>
+#include "GameJam2021.h"
+#include "GameJam2021Stats.h"
+#include "Engine/World.h"
+#include "Components/ChildActorComponent.h"
+
+void FGameJam2021CityGrid::Initialize(const FGameJam2021CityGridSettings& inSettings)
+{
+	Reset();
+
+	mSettings = inSettings;
+	mCells.Reset(mSettings.mLayout.mGridSize, mSettings.mChunkSize);
+
+	const int num_building_looks = (mSettings.mCityClass ? FMath::Max(mSettings.mCityClass->GetDefaultObject<AGameJam2021City>()->mNumBuildingLooks, 1) : 1);
+	FRandomStream random_stream(mSettings.mSeed);
+	const uint8 all_sides = RouteCore::ToMask(EDirection::BACK) | RouteCore::ToMask(EDirection::FORWARD) | RouteCore::ToMask(EDirection::LEFT) | RouteCore::ToMask(EDirection::RIGHT);
+	for (int cell_i = 0; cell_i < mCells.GetNumCells(); ++cell_i)
+	{
+		mCells.SetOccupancy(cell_i, RouteCore::FCityCells::OccupancyBuilding);
+		mCells.SetBuildingType(cell_i, static_cast<uint8>(random_stream.RandHelper(num_building_looks)));
+		mCells.SetTriggerSlots(cell_i, all_sides);
+	}
+
+	mChunkSlots.Init(INDEX_NONE, mCells.GetNumChunks());
+}
+
+void FGameJam2021CityGrid::Reset()
+{
+	while (mChunks.Num() > 0)
+		ReleaseChunk(mChunks.Num() - 1);
+
+	for (const FDeliveryTrigger& delivery_trigger : mDeliveryTriggers)
+	{
+		if (IsValid(delivery_trigger.mActor))
+			delivery_trigger.mActor->Destroy();
+	}
+	mDeliveryTriggers.Reset();
+	mActiveDeliveryTrigger = INDEX_NONE;
+
+	mChunkSlots.Reset();
+	mPendingChunks.Reset();
+	mNumSpawnedActors = 0;
+	mSpawnSeconds = 0.0;
+}
+
+void FGameJam2021CityGrid::UpdateStreaming(const FIntPoint& inCenterCell)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RemembikeCityStreaming);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FGameJam2021CityGrid::UpdateStreaming);
+	CSV_SCOPED_TIMING_STAT(Remembike, CityStreaming);
+
+	if (mCells.GetNumChunks() == 0)
+		return;
+
+	const RouteCore::FGridPosition center_chunk = mCells.GetChunkOfCell(RouteCore::FGridPosition(
+		FMath::Clamp(inCenterCell.X, 0, mCells.GetGridSize() - 1), FMath::Clamp(inCenterCell.Y, 0, mCells.GetGridSize() - 1)));
+	const int radius = FMath::Max(mSettings.mStreamingRadius, 0);
+
+	// Release first, with one chunk of hysteresis so riding along a chunk border does not respawn it every time
+	for (int chunk_slot = mChunks.Num() - 1; chunk_slot >= 0; --chunk_slot)
+	{
+		const FIntPoint& chunk_position = mChunks[chunk_slot].mChunkPosition;
+		const int distance = FMath::Max(FMath::Abs(chunk_position.X - center_chunk.X), FMath::Abs(chunk_position.Y - center_chunk.Y));
+		if (distance > radius + 1)
+			ReleaseChunk(chunk_slot);
+	}
+
+	// Queued chunks that drifted out of range are dropped with the same hysteresis
+	for (int pending_i = mPendingChunks.Num() - 1; pending_i >= 0; --pending_i)
+	{
+		const FIntPoint& chunk_position = mPendingChunks[pending_i];
+		const int distance = FMath::Max(FMath::Abs(chunk_position.X - center_chunk.X), FMath::Abs(chunk_position.Y - center_chunk.Y));
+		if (distance > radius + 1)
+			mPendingChunks.RemoveAt(pending_i);
+	}
+
+	// Chunks around the player are only queued, ring by ring from the center, and spawned by ProcessPendingChunks
+	for (int ring = 0; ring <= radius; ++ring)
+	{
+		for (int chunk_y = center_chunk.Y - ring; chunk_y <= center_chunk.Y + ring; ++chunk_y)
+		{
+			for (int chunk_x = center_chunk.X - ring; chunk_x <= center_chunk.X + ring; ++chunk_x)
+			{
+				const bool is_on_ring = (FMath::Abs(chunk_x - center_chunk.X) == ring || FMath::Abs(chunk_y - center_chunk.Y) == ring);
+				if (is_on_ring)
+					QueueChunk(FIntPoint(chunk_x, chunk_y));
+			}
+		}
+	}
+}
+
+int FGameJam2021CityGrid::ProcessPendingChunks(const double inBudgetSeconds)
+{
+	if (mPendingChunks.Num() == 0)
+		return 0;
+
+	SCOPE_CYCLE_COUNTER(STAT_RemembikeCityStreaming);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FGameJam2021CityGrid::ProcessPendingChunks);
+	CSV_SCOPED_TIMING_STAT(Remembike, CityStreaming);
+
+	// At least one chunk per call, so a tiny budget still makes progress
+	const double start_time = FPlatformTime::Seconds();
+	int num_materialized = 0;
+	while (mPendingChunks.Num() > 0 && (num_materialized == 0 || FPlatformTime::Seconds() - start_time < inBudgetSeconds))
+	{
+		const FIntPoint chunk_position = mPendingChunks[0];
+		mPendingChunks.RemoveAt(0, 1, false);
+		MaterializeChunk(chunk_position);
+		++num_materialized;
+	}
+	return mPendingChunks.Num();
+}
+
+void FGameJam2021CityGrid::QueueChunk(const FIntPoint& inChunkPosition)
+{
+	const RouteCore::FGridPosition chunk_position(inChunkPosition.X, inChunkPosition.Y);
+	if (!mCells.IsChunkInside(chunk_position) || mChunkSlots[mCells.GetChunkIndex(chunk_position)] != INDEX_NONE)
+		return;
+
+	mPendingChunks.AddUnique(inChunkPosition);
+}
+
+int FGameJam2021CityGrid::GetDeliveryTriggerIndex(const FIntPoint& inGridPosition, const EDirection& inBuildingSide) const
+{
+	return mCells.GetCellIndex(RouteCore::FGridPosition(inGridPosition.X, inGridPosition.Y)) * RouteCore::NumDirections + static_cast<int>(inBuildingSide);
+}
+
+AActor* FGameJam2021CityGrid::PlaceDeliveryTrigger(const FIntPoint& inGridPosition, const EDirection& inBuildingSide)
+{
+	if (!mCells.IsInside(RouteCore::FGridPosition(inGridPosition.X, inGridPosition.Y)))
+		return nullptr;
+
+	// Only known once the chunks around the player spawned their buildings when mDeliveryTriggerClass was not set
+	if (!ensureMsgf(mSettings.mDeliveryTriggerClass != nullptr, TEXT("No delivery trigger class, deliveries will not be shown")))
+		return nullptr;
+
+	// Moving the trigger runs overlap updates, which would deliver again right away if the player is standing in it
+	const int trigger_index = GetDeliveryTriggerIndex(inGridPosition, inBuildingSide);
+	if (mActiveDeliveryTrigger != INDEX_NONE && mDeliveryTriggers[mActiveDeliveryTrigger].mIndex == trigger_index)
+	{
+		AActor* actor = mDeliveryTriggers[mActiveDeliveryTrigger].mActor;
+		actor->SetActorHiddenInGame(false);
+		return actor;
+	}
+
+	const int trigger_slot = (mActiveDeliveryTrigger + 1) % NumPooledDeliveryTriggers;
+	if (trigger_slot >= mDeliveryTriggers.Num())
+	{
+		AActor* actor = mSettings.mWorld->SpawnActor<AActor>(mSettings.mDeliveryTriggerClass, FTransform::Identity);
+		if (!actor)
+			return nullptr;
+
+		actor->SetActorEnableCollision(false);
+		mDeliveryTriggers.Add(FDeliveryTrigger { actor, INDEX_NONE });
+	}
+
+	// The retired trigger can no longer make a delivery while it fades out
+	if (mActiveDeliveryTrigger != INDEX_NONE)
+		mDeliveryTriggers[mActiveDeliveryTrigger].mActor->SetActorEnableCollision(false);
+
+	FDeliveryTrigger& delivery_trigger = mDeliveryTriggers[trigger_slot];
+	delivery_trigger.mIndex = trigger_index;
+	delivery_trigger.mActor->SetActorLocation(GetGridWorldPosition(inGridPosition, inBuildingSide), false, nullptr, ETeleportType::TeleportPhysics);
+	delivery_trigger.mActor->SetActorEnableCollision(!mSettings.mDisableDeliveryTriggerCollision);
+	delivery_trigger.mActor->SetActorHiddenInGame(false);
+	mActiveDeliveryTrigger = trigger_slot;
+	return delivery_trigger.mActor;
+}
+
+AActor* FGameJam2021CityGrid::GetRetiredDeliveryTrigger() const
+{
+	if (mActiveDeliveryTrigger == INDEX_NONE)
+		return nullptr;
+
+	const int trigger_slot = (mActiveDeliveryTrigger + 1) % NumPooledDeliveryTriggers;
+	return (mDeliveryTriggers.IsValidIndex(trigger_slot) ? mDeliveryTriggers[trigger_slot].mActor : nullptr);
+}
+
+const int* FGameJam2021CityGrid::FindDeliveryTriggerIndex(const AActor* inTrigger) const
+{
+	for (const FDeliveryTrigger& delivery_trigger : mDeliveryTriggers)
+	{
+		if (inTrigger && delivery_trigger.mActor == inTrigger)
+			return &delivery_trigger.mIndex;
+	}
+	return nullptr;
+}
+
+FIntPoint FGameJam2021CityGrid::GetCellAtWorldPosition(const FVector& inWorldPosition) const
+{
+	RouteCore::FWorldPosition world_position;
+	world_position.X = inWorldPosition.X;
+	world_position.Y = inWorldPosition.Y;
+	const RouteCore::FGridPosition cell = mSettings.mLayout.GetGridPosition(world_position);
+	return FIntPoint(cell.X, cell.Y);
+}
+
+bool FGameJam2021CityGrid::IsInDeliveryZone(const FVector& inWorldPosition, const float inRadius, const FIntPoint& inGridPosition, const EDirection& inBuildingSide) const
+{
+	return FVector::DistSquaredXY(GetGridWorldPosition(inGridPosition, inBuildingSide), inWorldPosition) <= FMath::Square(inRadius);
+}
+
+void FGameJam2021CityGrid::MaterializeChunk(const FIntPoint& inChunkPosition)
+{
+	const RouteCore::FGridPosition chunk_position(inChunkPosition.X, inChunkPosition.Y);
+	if (!mCells.IsChunkInside(chunk_position))
+		return;
+
+	int16& chunk_slot = mChunkSlots[mCells.GetChunkIndex(chunk_position)];
+	if (chunk_slot != INDEX_NONE)
+		return;
+
+	const double spawn_start_time = FPlatformTime::Seconds();
+
+	chunk_slot = static_cast<int16>(mChunks.AddDefaulted());
+	INC_DWORD_STAT(STAT_RemembikeCityChunks);
+	FChunk& chunk = mChunks[chunk_slot];
+	chunk.mChunkPosition = inChunkPosition;
+
+	RouteCore::FGridPosition min_cell;
+	RouteCore::FGridPosition end_cell;
+	mCells.GetChunkCells(chunk_position, min_cell, end_cell);
+	if (mSettings.mCityClass)
+		SpawnChunkInstances(chunk, FIntPoint(min_cell.X, min_cell.Y), FIntPoint(end_cell.X, end_cell.Y));
+	else
+		SpawnChunkActors(chunk, FIntPoint(min_cell.X, min_cell.Y), FIntPoint(end_cell.X, end_cell.Y));
+
+	const double spawn_seconds = FPlatformTime::Seconds() - spawn_start_time;
+	mSpawnSeconds += spawn_seconds;
+	UE_LOG(LogRemembike, Verbose, TEXT("Materialized city chunk %s in %.3f ms, %d chunks materialized"), *inChunkPosition.ToString(), spawn_seconds * 1000.0, mChunks.Num());
+}
+
+void FGameJam2021CityGrid::ReleaseChunk(const int inChunkSlot)
+{
+	FChunk& chunk = mChunks[inChunkSlot];
+	for (AActor* actor : chunk.mActors)
+	{
+		if (IsValid(actor))
+			actor->Destroy();
+	}
+	mNumSpawnedActors -= chunk.mActors.Num();
+	DEC_DWORD_STAT_BY(STAT_RemembikeCityActors, chunk.mActors.Num());
+	DEC_DWORD_STAT(STAT_RemembikeCityChunks);
+
+	const RouteCore::FGridPosition chunk_position(chunk.mChunkPosition.X, chunk.mChunkPosition.Y);
+	if (mChunkSlots.IsValidIndex(mCells.GetChunkIndex(chunk_position)))
+		mChunkSlots[mCells.GetChunkIndex(chunk_position)] = INDEX_NONE;
+
+	mChunks.RemoveAtSwap(inChunkSlot);
+	if (mChunks.IsValidIndex(inChunkSlot))
+	{
+		const FIntPoint& moved_chunk_position = mChunks[inChunkSlot].mChunkPosition;
+		mChunkSlots[mCells.GetChunkIndex(RouteCore::FGridPosition(moved_chunk_position.X, moved_chunk_position.Y))] = static_cast<int16>(inChunkSlot);
+	}
+}
+
+void FGameJam2021CityGrid::SpawnChunkActors(FChunk& ioChunk, const FIntPoint& inMinCell, const FIntPoint& inEndCell)
+{
+	// Delivery trigger tags of the building child actors, only built once here
+	static const std::array<FName, RouteCore::NumDirections> delivery_trigger_tags =
+	{
+		FName(TEXT("DeliveryTrigger_BACK")), FName(TEXT("DeliveryTrigger_FORWARD")), FName(TEXT("DeliveryTrigger_LEFT")), FName(TEXT("DeliveryTrigger_RIGHT"))
+	};
+
+	if (mSettings.mBuildingClass)
+	{
+		for (int y = inMinCell.Y; y < inEndCell.Y; ++y)
+		{
+			for (int x = inMinCell.X; x < inEndCell.X; ++x)
+			{
+				const int cell_i = mCells.GetCellIndex(RouteCore::FGridPosition(x, y));
+				if (mCells.GetOccupancy(cell_i) != RouteCore::FCityCells::OccupancyBuilding)
+					continue;
+
+				AActor* building = SpawnActor(ioChunk, mSettings.mBuildingClass, FTransform(GetGridWorldPosition(FIntPoint(x, y))));
+				if (!building)
+					continue;
+
+				// The delivery is marked by the trigger pool of PlaceDeliveryTrigger, so the per side triggers of the
+				// building are destroyed. Their class is the pool class when none is set.
+				TArray<UChildActorComponent*> building_child_actor_components;
+				building->GetComponents<UChildActorComponent>(building_child_actor_components, true);
+				for (UChildActorComponent* building_child_actor_comp : building_child_actor_components)
+				{
+					const bool is_delivery_trigger = delivery_trigger_tags.end() != std::find_if(delivery_trigger_tags.begin(), delivery_trigger_tags.end(),
+						[building_child_actor_comp](const FName& inTag) { return building_child_actor_comp->ComponentHasTag(inTag); });
+					if (!is_delivery_trigger)
+					{
+						building_child_actor_comp->GetChildActor()->SetActorHiddenInGame(true);
+						continue;
+					}
+
+					if (!mSettings.mDeliveryTriggerClass)
+						mSettings.mDeliveryTriggerClass = building_child_actor_comp->GetChildActorClass();
+					building_child_actor_comp->DestroyComponent();
+				}
+			}
+		}
+	}
+
+	if (mSettings.mBarrierClass)
+	{
+		TArray<FTransform> barrier_transforms;
+		GetChunkBarrierTransforms(inMinCell, inEndCell, barrier_transforms);
+		for (const FTransform& barrier_transform : barrier_transforms)
+			SpawnActor(ioChunk, mSettings.mBarrierClass, barrier_transform);
+	}
+}
+
+void FGameJam2021CityGrid::SpawnChunkInstances(FChunk& ioChunk, const FIntPoint& inMinCell, const FIntPoint& inEndCell)
+{
+	ioChunk.mCity = Cast<AGameJam2021City>(SpawnActor(ioChunk, mSettings.mCityClass, FTransform::Identity));
+	if (!ensure(ioChunk.mCity != nullptr))
+		return;
+
+	TArray<FTransform> building_transforms;
+	TArray<int> building_looks;
+	for (int y = inMinCell.Y; y < inEndCell.Y; ++y)
+	{
+		for (int x = inMinCell.X; x < inEndCell.X; ++x)
+		{
+			const int cell_i = mCells.GetCellIndex(RouteCore::FGridPosition(x, y));
+			if (mCells.GetOccupancy(cell_i) != RouteCore::FCityCells::OccupancyBuilding)
+				continue;
+
+			building_transforms.Add(FTransform(GetGridWorldPosition(FIntPoint(x, y))));
+			building_looks.Add(mCells.GetBuildingType(cell_i));
+		}
+	}
+
+	TArray<FTransform> barrier_transforms;
+	GetChunkBarrierTransforms(inMinCell, inEndCell, barrier_transforms);
+
+	ioChunk.mCity->BuildInstances(building_transforms, building_looks, barrier_transforms);
+}
+
+void FGameJam2021CityGrid::GetChunkBarrierTransforms(const FIntPoint& inMinCell, const FIntPoint& inEndCell, TArray<FTransform>& outBarrierTransforms) const
+{
+	// Barriers sit one cell outside the grid, the corners belong to the chunk at that corner
+	const int grid_size = mCells.GetGridSize();
+	const int min_y = (inMinCell.Y == 0 ? -1 : inMinCell.Y);
+	const int end_y = (inEndCell.Y == grid_size ? grid_size + 1 : inEndCell.Y);
+	const int min_x = (inMinCell.X == 0 ? -1 : inMinCell.X);
+	const int end_x = (inEndCell.X == grid_size ? grid_size + 1 : inEndCell.X);
+
+	outBarrierTransforms.Reset();
+
+	for (int y = min_y; y < end_y; ++y)
+	{
+		for (int x : { -1, grid_size })
+		{
+			if (x < min_x || x >= end_x)
+				continue;
+			outBarrierTransforms.Add(FTransform(FRotator(0, x == -1 ? 180 : 0, 0), GetGridWorldPosition(FIntPoint(x, y))));
+		}
+	}
+
+	for (int x = min_x; x < end_x; ++x)
+	{
+		for (int y : { -1, grid_size })
+		{
+			if (y < min_y || y >= end_y)
+				continue;
+			outBarrierTransforms.Add(FTransform(FRotator(0, y == -1 ? 90 : -90, 0), GetGridWorldPosition(FIntPoint(x, y))));
+		}
+	}
+}
+
+AActor* FGameJam2021CityGrid::SpawnActor(FChunk& ioChunk, UClass* inClass, const FTransform& inTransform)
+{
+	AActor* actor = mSettings.mWorld->SpawnActor<AActor>(inClass, inTransform);
+	if (actor)
+	{
+		ioChunk.mActors.Add(actor);
+		++mNumSpawnedActors;
+		INC_DWORD_STAT(STAT_RemembikeCityActors);
+	}
+	return actor;
+}
+
+FVector FGameJam2021CityGrid::GetGridWorldPosition(const FIntPoint& inGridPosition) const
+{
+	const RouteCore::FWorldPosition world_pos = mSettings.mLayout.GetGridWorldPosition(RouteCore::FGridPosition(inGridPosition.X, inGridPosition.Y));
+	return FVector(world_pos.X, world_pos.Y, 0);
+}
+
+FVector FGameJam2021CityGrid::GetGridWorldPosition(const FIntPoint& inGridPosition, const EDirection& inBuildingSide) const
+{
+	const RouteCore::FWorldPosition world_pos = mSettings.mLayout.GetGridWorldPosition(RouteCore::FGridPosition(inGridPosition.X, inGridPosition.Y), inBuildingSide);
+	return FVector(world_pos.X, world_pos.Y, 0);
+}
@@ -0,0 +1,107 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameJam2021City.h"
+#include "RouteCore/CityCells.h"
+
+struct FGameJam2021CityGridSettings
+{
+	UWorld* mWorld = nullptr;
+	UClass* mBuildingClass = nullptr;
+	UClass* mBarrierClass = nullptr;
+	TSubclassOf<AGameJam2021City> mCityClass = nullptr;
+	UClass* mDeliveryTriggerClass = nullptr;
+
+	RouteCore::FCityLayout mLayout;
+	int mChunkSize = 8;
+
+	// Seed of the building looks
+	int32 mSeed = 0;
+
+	// Chunks within this many chunks of the player are materialized, chunks further than one more are released
+	int mStreamingRadius = 2;
+
+	// Spawned delivery triggers get no collision, for when deliveries are detected with IsInDeliveryZone instead
+	bool mDisableDeliveryTriggerCollision = false;
+};
+
+// Runtime-sized city made of a flat cell store for the whole grid and actors that only exist for the chunks
+// around the player, so spawn time and memory follow the visible area. Deliveries are marked by a pool of two
+// triggers that are moved around instead of one trigger per building side: the active one, and the previous one while
+// it fades out.
+class FGameJam2021CityGrid
+{
+public:
+	using EDirection = RouteCore::EDirection;
+
+	void Initialize(const FGameJam2021CityGridSettings& inSettings);
+	void Reset();
+
+	// Queues the chunks around inCenterCell and releases the ones far from it
+	void UpdateStreaming(const FIntPoint& inCenterCell);
+
+	// Materializes queued chunks, nearest first, until inBudgetSeconds are spent. Returns how many are still queued.
+	int ProcessPendingChunks(const double inBudgetSeconds);
+	int GetNumPendingChunks() const { return mPendingChunks.Num(); }
+
+	int GetDeliveryTriggerIndex(const FIntPoint& inGridPosition, const EDirection& inBuildingSide) const;
+
+	// Moves the other trigger of the pool to a building side, shows it and makes it the active one. The previously
+	// active trigger loses its collision and is left where it was, see GetRetiredDeliveryTrigger. When the active
+	// trigger is already at that side it stays in place, so a player standing in it does not get a new overlap event.
+	AActor* PlaceDeliveryTrigger(const FIntPoint& inGridPosition, const EDirection& inBuildingSide);
+
+	// The trigger that was active before the last one placed, left to fade out. Null until two were placed.
+	AActor* GetRetiredDeliveryTrigger() const;
+	const int* FindDeliveryTriggerIndex(const AActor* inTrigger) const;
+
+	FIntPoint GetCellAtWorldPosition(const FVector& inWorldPosition) const;
+
+	// Whether inWorldPosition is within inRadius of the delivery trigger position of a building side
+	bool IsInDeliveryZone(const FVector& inWorldPosition, const float inRadius, const FIntPoint& inGridPosition, const EDirection& inBuildingSide) const;
+	const RouteCore::FCityCells& GetCells() const { return mCells; }
+	bool IsInstanced() const { return mSettings.mCityClass != nullptr; }
+
+	int GetNumMaterializedChunks() const { return mChunks.Num(); }
+	int GetNumSpawnedActors() const { return mNumSpawnedActors; }
+	double GetSpawnSeconds() const { return mSpawnSeconds; }
+
+private:
+	struct FChunk
+	{
+		FIntPoint mChunkPosition = FIntPoint(0, 0);
+		TArray<AActor*> mActors;
+		AGameJam2021City* mCity = nullptr;
+	};
+
+	struct FDeliveryTrigger
+	{
+		AActor* mActor = nullptr;
+		int mIndex = INDEX_NONE; // GetDeliveryTriggerIndex of the building side it was placed at
+	};
+	static constexpr int NumPooledDeliveryTriggers = 2;
+
+	void QueueChunk(const FIntPoint& inChunkPosition);
+	void MaterializeChunk(const FIntPoint& inChunkPosition);
+	void ReleaseChunk(const int inChunkSlot);
+	void SpawnChunkActors(FChunk& ioChunk, const FIntPoint& inMinCell, const FIntPoint& inEndCell);
+	void SpawnChunkInstances(FChunk& ioChunk, const FIntPoint& inMinCell, const FIntPoint& inEndCell);
+	void GetChunkBarrierTransforms(const FIntPoint& inMinCell, const FIntPoint& inEndCell, TArray<FTransform>& outBarrierTransforms) const;
+	AActor* SpawnActor(FChunk& ioChunk, UClass* inClass, const FTransform& inTransform);
+	FVector GetGridWorldPosition(const FIntPoint& inGridPosition) const;
+	FVector GetGridWorldPosition(const FIntPoint& inGridPosition, const EDirection& inBuildingSide) const;
+
+	FGameJam2021CityGridSettings mSettings;
+	RouteCore::FCityCells mCells;
+
+	TArray<FChunk> mChunks;
+	TArray<int16> mChunkSlots; // Index in mChunks of every chunk of the grid, INDEX_NONE when not materialized
+	TArray<FIntPoint> mPendingChunks; // Chunks waiting to be materialized, nearest to the player first
+	TArray<FDeliveryTrigger, TInlineAllocator<NumPooledDeliveryTriggers>> mDeliveryTriggers;
+	int mActiveDeliveryTrigger = INDEX_NONE;
+
+	int mNumSpawnedActors = 0;
+	double mSpawnSeconds = 0.0;
+};
@@ -0,0 +1,194 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021Crowd.h"
+#include "GameJam2021.h"
+#include "GameJam2021SpriteInstancesComponent.h"
+#include "GameJam2021Stats.h"
+#include "PaperFlipbook.h"
+#include "Async/ParallelFor.h"
+#include "Kismet/GameplayStatics.h"
+#include "Camera/PlayerCameraManager.h"
+
+namespace
+{
+	// Pedestrians simulated by one ParallelFor task
+	constexpr int PedestrianBatchSize = 64;
+
+	// Corners around a building, in walking order
+	constexpr int NumCorners = 4;
+	const FVector2D CornerSigns[NumCorners] = { FVector2D(-1, -1), FVector2D(1, -1), FVector2D(1, 1), FVector2D(-1, 1) };
+}
+
+AGameJam2021Crowd::AGameJam2021Crowd()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	mSpriteInstances = CreateDefaultSubobject<UGameJam2021SpriteInstancesComponent>(TEXT("SpriteInstances"));
+	mSpriteInstances->SetupAttachment(RootComponent);
+	mSpriteInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
+void AGameJam2021Crowd::Initialize(const RouteCore::FCityLayout& inLayout, const int inNumPedestrians, const int32 inSeed)
+{
+	mLayout = inLayout;
+	mSeed = inSeed;
+
+	const int num_pedestrians = FMath::Max(inNumPedestrians, 0);
+	mPositions.SetNumUninitialized(num_pedestrians);
+	mVelocities.SetNumZeroed(num_pedestrians);
+	mGoals.SetNumUninitialized(num_pedestrians);
+	mCells.SetNumUninitialized(num_pedestrians);
+	mGoalCorners.SetNumUninitialized(num_pedestrians);
+	mWalkDirections.SetNumUninitialized(num_pedestrians);
+
+	mSpriteInstances->ClearSpriteInstances();
+
+	FRandomStream random_stream(mSeed);
+	for (int pedestrian_i = 0; pedestrian_i < num_pedestrians; ++pedestrian_i)
+	{
+		const FIntPoint cell(random_stream.RandHelper(mLayout.mGridSize), random_stream.RandHelper(mLayout.mGridSize));
+		const int corner = random_stream.RandHelper(NumCorners);
+		mCells[pedestrian_i] = cell;
+		mWalkDirections[pedestrian_i] = (random_stream.RandHelper(2) == 0 ? 1 : -1);
+		mGoalCorners[pedestrian_i] = static_cast<uint8>((corner + NumCorners + mWalkDirections[pedestrian_i]) % NumCorners);
+		mPositions[pedestrian_i] = FMath::Lerp(GetCornerPosition(cell, corner), GetCornerPosition(cell, mGoalCorners[pedestrian_i]), random_stream.FRand());
+		mGoals[pedestrian_i] = GetCornerPosition(cell, mGoalCorners[pedestrian_i]);
+		const float animation_phase = random_stream.FRand();
+
+		// Flipbooks are played by the component at their own frame rate, each pedestrian from a different frame
+		const FTransform transform(FVector(mPositions[pedestrian_i], mSpriteHeight));
+		if (mFlipbookVariants.Num() > 0)
+		{
+			UPaperFlipbook* flipbook = mFlipbookVariants[random_stream.RandHelper(mFlipbookVariants.Num())];
+			mSpriteInstances->AddFlipbookInstance(transform, flipbook, 1.0f, true, flipbook ? animation_phase * flipbook->GetTotalDuration() : 0.0f);
+		}
+		else
+		{
+			UPaperSprite* sprite = (mSpriteVariants.Num() > 0 ? mSpriteVariants[random_stream.RandHelper(mSpriteVariants.Num())] : nullptr);
+			mSpriteInstances->AddSpriteInstance(transform, sprite, true);
+		}
+	}
+
+	UE_LOG(LogRemembike, Display, TEXT("Crowd of %d pedestrians in %d sprite and %d flipbook variants, drawn in %d batches"), num_pedestrians,
+		mSpriteVariants.Num(), mFlipbookVariants.Num(), mSpriteInstances->GetNumBatches());
+}
+
+void AGameJam2021Crowd::Simulate(const float inDeltaTime, const bool inAllowParallel)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RemembikeCrowdSimulation);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AGameJam2021Crowd::Simulate);
+	CSV_SCOPED_TIMING_STAT(Remembike, CrowdSimulation);
+
+	const int num_pedestrians = GetNumPedestrians();
+	const int num_batches = FMath::DivideAndRoundUp(num_pedestrians, PedestrianBatchSize);
+	const bool is_parallel = (inAllowParallel && mMinParallelPedestrians > 0 && num_pedestrians >= mMinParallelPedestrians);
+	ParallelFor(num_batches, [this, num_pedestrians, inDeltaTime](int32 inBatch)
+	{
+		const int begin = inBatch * PedestrianBatchSize;
+		SimulateRange(begin, FMath::Min(begin + PedestrianBatchSize, num_pedestrians), inDeltaTime);
+	}, !is_parallel);
+}
+
+void AGameJam2021Crowd::SimulateRange(const int inBegin, const int inEnd, const float inDeltaTime)
+{
+	const float step_distance = mWalkSpeed * inDeltaTime;
+
+	for (int pedestrian_i = inBegin; pedestrian_i < inEnd; ++pedestrian_i)
+	{
+		FVector2D& position = mPositions[pedestrian_i];
+		const FVector2D to_goal = mGoals[pedestrian_i] - position;
+		const float goal_distance = to_goal.Size();
+		if (goal_distance <= step_distance)
+		{
+			// Turn the corner, the rest of the step is left for the next tick
+			position = mGoals[pedestrian_i];
+			mGoalCorners[pedestrian_i] = static_cast<uint8>((mGoalCorners[pedestrian_i] + NumCorners + mWalkDirections[pedestrian_i]) % NumCorners);
+			mGoals[pedestrian_i] = GetCornerPosition(mCells[pedestrian_i], mGoalCorners[pedestrian_i]);
+		}
+		else
+		{
+			mVelocities[pedestrian_i] = to_goal * (mWalkSpeed / goal_distance);
+			position += mVelocities[pedestrian_i] * inDeltaTime;
+		}
+	}
+}
+
+void AGameJam2021Crowd::UpdateInstances(const FVector& inCameraLocation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RemembikeCrowdInstances);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AGameJam2021Crowd::UpdateInstances);
+	CSV_SCOPED_TIMING_STAT(Remembike, CrowdInstances);
+
+	// Render state is rebuilt once for all the instances
+	for (int pedestrian_i = 0; pedestrian_i < GetNumPedestrians(); ++pedestrian_i)
+	{
+		const FVector location(mPositions[pedestrian_i], mSpriteHeight);
+		const float yaw = FMath::RadiansToDegrees(FMath::Atan2(inCameraLocation.Y - location.Y, inCameraLocation.X - location.X)) + mSpriteYawOffset;
+		mSpriteInstances->UpdateInstanceTransform(pedestrian_i, FTransform(FRotator(0.0f, yaw, 0.0f), location), true, false, true);
+	}
+	mSpriteInstances->MarkRenderStateDirty();
+}
+
+void AGameJam2021Crowd::Tick(float inDeltaTime)
+{
+	Super::Tick(inDeltaTime);
+
+	if (GetNumPedestrians() == 0)
+		return;
+
+	Simulate(inDeltaTime);
+
+	const APlayerCameraManager* camera_manager = UGameplayStatics::GetPlayerCameraManager(this, 0);
+	UpdateInstances(camera_manager ? camera_manager->GetCameraLocation() : FVector::ZeroVector);
+}
+
+void AGameJam2021Crowd::RunBenchmark(const int inNumSteps)
+{
+	const int previous_num_pedestrians = GetNumPedestrians();
+	const int num_steps = FMath::Max(inNumSteps, 1);
+	const float step_seconds = 1.0f / 60.0f;
+
+	for (const int num_pedestrians : { 10, 100, 1000 })
+	{
+		Initialize(mLayout, num_pedestrians, mSeed);
+
+		double simulation_seconds[2] = { 0.0, 0.0 };
+		for (int parallel_i = 0; parallel_i < 2; ++parallel_i)
+		{
+			// mMinParallelPedestrians only decides whether the parallel pass is used, here both are timed
+			const int min_parallel_pedestrians = mMinParallelPedestrians;
+			mMinParallelPedestrians = 1;
+			const double start_time = FPlatformTime::Seconds();
+			for (int step_i = 0; step_i < num_steps; ++step_i)
+				Simulate(step_seconds, parallel_i == 1);
+			simulation_seconds[parallel_i] = FPlatformTime::Seconds() - start_time;
+			mMinParallelPedestrians = min_parallel_pedestrians;
+		}
+
+		const double instances_start_time = FPlatformTime::Seconds();
+		for (int step_i = 0; step_i < num_steps; ++step_i)
+			UpdateInstances(FVector::ZeroVector);
+		const double instances_seconds = FPlatformTime::Seconds() - instances_start_time;
+
+		UE_LOG(LogRemembike, Display, TEXT("Crowd of %4d: simulation %.2f us serial, %.2f us parallel, instance update %.2f us per step, %d primitive components, %d sprite batches"),
+			num_pedestrians, simulation_seconds[0] * 1e6 / num_steps, simulation_seconds[1] * 1e6 / num_steps, instances_seconds * 1e6 / num_steps,
+			GetNumPrimitiveComponents(), mSpriteInstances->GetNumBatches());
+	}
+
+	Initialize(mLayout, previous_num_pedestrians, mSeed);
+}
+
+int AGameJam2021Crowd::GetNumPrimitiveComponents() const
+{
+	TArray<UPrimitiveComponent*> primitive_components;
+	GetComponents(primitive_components);
+	return primitive_components.Num();
+}
+
+FVector2D AGameJam2021Crowd::GetCornerPosition(const FIntPoint& inCell, const int inCorner) const
+{
+	const RouteCore::FWorldPosition center = mLayout.GetGridWorldPosition(RouteCore::FGridPosition(inCell.X, inCell.Y));
+	return FVector2D(center.X, center.Y) + CornerSigns[inCorner] * (mLayout.mBuildingSize * mSidewalkDistance);
+}
@@ -0,0 +1,84 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "RouteCore/CityGrid.h"
+#include "GameJam2021Crowd.generated.h"
+
+class UGameJam2021SpriteInstancesComponent;
+class UPaperFlipbook;
+class UPaperSprite;
+
+// Pedestrians walking around the city blocks, simulated as plain arrays in one batched pass per tick and drawn as
+// instances of a single sprite instances component, instead of one pawn and AI controller per granny.
+// Every pedestrian walks the sidewalk around one building, corner to corner, in either direction.
+UCLASS()
+class AGameJam2021Crowd : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AGameJam2021Crowd();
+
+	// One of these per pedestrian, picked at random
+	UPROPERTY(EditAnywhere)
+	TArray<UPaperSprite*> mSpriteVariants;
+
+	// Used instead of mSpriteVariants when set, played by the sprite instances component from a random start time
+	UPROPERTY(EditAnywhere)
+	TArray<UPaperFlipbook*> mFlipbookVariants;
+
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+	float mWalkSpeed = 60.0f;
+
+	// Distance of the sidewalk to the building center, as a fraction of the building size
+	UPROPERTY(EditAnywhere)
+	float mSidewalkDistance = 0.4f;
+
+	// Height of the sprite pivots over the street
+	UPROPERTY(EditAnywhere)
+	float mSpriteHeight = 50.0f;
+
+	// Yaw added to the rotation that turns +X toward the camera. Paper2D sprites face +Y, hence the default.
+	UPROPERTY(EditAnywhere)
+	float mSpriteYawOffset = -90.0f;
+
+	// Simulates on worker threads with ParallelFor once there are at least this many pedestrians, 0 never does
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+	int mMinParallelPedestrians = 256;
+
+	void Initialize(const RouteCore::FCityLayout& inLayout, const int inNumPedestrians, const int32 inSeed);
+
+	void Simulate(const float inDeltaTime, const bool inAllowParallel = true);
+	void UpdateInstances(const FVector& inCameraLocation);
+
+	// Times Simulate and UpdateInstances for 10, 100 and 1000 pedestrians, serial and parallel, and logs the results.
+	// The crowd is initialized back to its previous size afterwards.
+	void RunBenchmark(const int inNumSteps);
+
+	int GetNumPedestrians() const { return mPositions.Num(); }
+	int GetNumPrimitiveComponents() const;
+
+protected:
+	virtual void Tick(float inDeltaTime) override;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UGameJam2021SpriteInstancesComponent* mSpriteInstances = nullptr;
+
+private:
+	void SimulateRange(const int inBegin, const int inEnd, const float inDeltaTime);
+	FVector2D GetCornerPosition(const FIntPoint& inCell, const int inCorner) const;
+
+	RouteCore::FCityLayout mLayout;
+	int32 mSeed = 0;
+
+	// Per pedestrian, all the same length
+	TArray<FVector2D> mPositions;
+	TArray<FVector2D> mVelocities;
+	TArray<FVector2D> mGoals;
+	TArray<FIntPoint> mCells;
+	TArray<uint8> mGoalCorners;
+	TArray<int8> mWalkDirections; // 1 or -1, the order the corners are walked in
+};
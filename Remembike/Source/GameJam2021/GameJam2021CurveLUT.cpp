@@ -0,0 +1,31 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021CurveLUT.h"
+
+void FGameJam2021FloatCurveLUT::Bake(const UCurveFloat* inCurve, const int inNumSamples)
+{
+	if (!inCurve)
+	{
+		Reset();
+		return;
+	}
+
+	float min_time = 0.0f;
+	float max_time = 0.0f;
+	inCurve->GetTimeRange(min_time, max_time);
+	TGameJam2021CurveLUT<float>::Bake(min_time, max_time, inNumSamples, [inCurve](const float inTime) { return inCurve->GetFloatValue(inTime); });
+}
+
+void FGameJam2021VectorCurveLUT::Bake(const UCurveVector* inCurve, const int inNumSamples)
+{
+	if (!inCurve)
+	{
+		Reset();
+		return;
+	}
+
+	float min_time = 0.0f;
+	float max_time = 0.0f;
+	inCurve->GetTimeRange(min_time, max_time);
+	TGameJam2021CurveLUT<FVector>::Bake(min_time, max_time, inNumSamples, [inCurve](const float inTime) { return inCurve->GetVectorValue(inTime); });
+}
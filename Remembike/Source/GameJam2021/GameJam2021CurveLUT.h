@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Curves/CurveFloat.h"
+#include "Curves/CurveVector.h"
+
+// Curve sampled at evenly spaced times over its key range, evaluated with linear interpolation between the samples
+// and clamped at both ends. Meant to be baked once when the curve asset is loaded, so evaluating it in the tick is
+// a multiply and a lerp instead of a key search.
+template <typename TValue>
+class TGameJam2021CurveLUT
+{
+public:
+	static constexpr int DefaultNumSamples = 64;
+
+	template <typename TEvalFunction>
+	void Bake(const float inMinTime, const float inMaxTime, const int inNumSamples, TEvalFunction&& inEvalFunction)
+	{
+		const int num_samples = FMath::Max(inNumSamples, 2);
+		mMinTime = inMinTime;
+		mTimeToSample = (inMaxTime > inMinTime ? (num_samples - 1) / (inMaxTime - inMinTime) : 0.0f);
+
+		mSamples.SetNumUninitialized(num_samples);
+		for (int sample_i = 0; sample_i < num_samples; ++sample_i)
+		{
+			const float time = inMinTime + (inMaxTime - inMinTime) * sample_i / (num_samples - 1);
+			mSamples[sample_i] = inEvalFunction(time);
+		}
+	}
+
+	void Reset() { mSamples.Reset(); }
+	bool IsBaked() const { return mSamples.Num() > 0; }
+
+	TValue Eval(const float inTime) const
+	{
+		check(IsBaked());
+		const float sample = FMath::Clamp((inTime - mMinTime) * mTimeToSample, 0.0f, static_cast<float>(mSamples.Num() - 1));
+		const int sample_i = FMath::Min(static_cast<int>(sample), mSamples.Num() - 2);
+		return FMath::Lerp(mSamples[sample_i], mSamples[sample_i + 1], sample - sample_i);
+	}
+
+private:
+	TArray<TValue> mSamples;
+	float mMinTime = 0.0f;
+	float mTimeToSample = 0.0f;
+};
+
+class FGameJam2021FloatCurveLUT : public TGameJam2021CurveLUT<float>
+{
+public:
+	void Bake(const UCurveFloat* inCurve, const int inNumSamples = DefaultNumSamples);
+};
+
+class FGameJam2021VectorCurveLUT : public TGameJam2021CurveLUT<FVector>
+{
+public:
+	void Bake(const UCurveVector* inCurve, const int inNumSamples = DefaultNumSamples);
+};
@@ -0,0 +1,157 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021DeliveryContent.h"
+#include "GameJam2021.h"
+#include "PaperSprite.h"
+#include "Particles/ParticleSystem.h"
+
+FGameJam2021DeliveryContent::~FGameJam2021DeliveryContent()
+{
+	Shutdown();
+}
+
+void FGameJam2021DeliveryContent::Initialize(const TArray<FGameJam2021DeliveryVariant>& inVariants, const TSoftObjectPtr<UParticleSystem>& inParticles, const int inNumUpcomingDeliveries, const uint32 inSeed)
+{
+	Shutdown();
+
+	mVariants = inVariants;
+	mParticles = inParticles;
+	mNumUpcomingDeliveries = FMath::Max(inNumUpcomingDeliveries, 0);
+	mRandomStream.Initialize(static_cast<int32>(inSeed));
+	mNumDeliveries = 0;
+	mNumLoadRequests = 0;
+	mNumLateLoads = 0;
+
+	if (!mParticles.IsNull())
+		mParticlesHandle = RequestLoad({ mParticles.ToSoftObjectPath() });
+
+	// The first delivery and the ones after it start loading right away
+	for (int delivery_i = 0; delivery_i <= mNumUpcomingDeliveries && mVariants.Num() > 0; ++delivery_i)
+		mUpcomingVariants.Add(mRandomStream.RandHelper(mVariants.Num()));
+	UpdateResidentVariants();
+}
+
+void FGameJam2021DeliveryContent::Shutdown()
+{
+	// Canceled handles do not call their delegates, so nothing is called back after this
+	for (TPair<int, TSharedPtr<FStreamableHandle>>& handle : mHandles)
+	{
+		if (handle.Value.IsValid())
+			handle.Value->CancelHandle();
+	}
+	mHandles.Reset();
+	mUpcomingVariants.Reset();
+
+	if (mParticlesHandle.IsValid())
+		mParticlesHandle->CancelHandle();
+	mParticlesHandle.Reset();
+}
+
+void FGameJam2021DeliveryContent::AdvanceDelivery(TFunction<void()> inOnLoaded)
+{
+	if (mVariants.Num() == 0)
+	{
+		inOnLoaded();
+		return;
+	}
+
+	if (mNumDeliveries++ > 0)
+		mUpcomingVariants.RemoveAt(0, 1, false);
+	while (mUpcomingVariants.Num() <= mNumUpcomingDeliveries)
+		mUpcomingVariants.Add(mRandomStream.RandHelper(mVariants.Num()));
+	UpdateResidentVariants();
+
+	const TSharedPtr<FStreamableHandle>* handle = mHandles.Find(mUpcomingVariants[0]);
+	if (!handle || !handle->IsValid() || (*handle)->HasLoadCompleted())
+	{
+		inOnLoaded();
+		return;
+	}
+
+	// Still loading, the delivery is shown without its content until then
+	++mNumLateLoads;
+	UE_LOG(LogRemembike, Verbose, TEXT("Delivery content of variant %d is not loaded yet"), mUpcomingVariants[0]);
+	(*handle)->BindCompleteDelegate(FStreamableDelegate::CreateLambda(MoveTemp(inOnLoaded)));
+}
+
+void FGameJam2021DeliveryContent::UpdateResidentVariants()
+{
+	// Released handles leave their assets to the next garbage collection
+	for (auto handle_it = mHandles.CreateIterator(); handle_it; ++handle_it)
+	{
+		if (mUpcomingVariants.Contains(handle_it->Key))
+			continue;
+
+		if (handle_it->Value.IsValid())
+			handle_it->Value->ReleaseHandle();
+		handle_it.RemoveCurrent();
+	}
+
+	for (const int variant_i : mUpcomingVariants)
+	{
+		if (mHandles.Contains(variant_i))
+			continue;
+
+		const FGameJam2021DeliveryVariant& variant = mVariants[variant_i];
+		TArray<FSoftObjectPath> paths;
+		if (!variant.mGrannySprite.IsNull())
+			paths.Add(variant.mGrannySprite.ToSoftObjectPath());
+		if (!variant.mThankYouSprite.IsNull())
+			paths.Add(variant.mThankYouSprite.ToSoftObjectPath());
+		mHandles.Add(variant_i, paths.Num() > 0 ? RequestLoad(paths) : nullptr);
+	}
+}
+
+TSharedPtr<FStreamableHandle> FGameJam2021DeliveryContent::RequestLoad(const TArray<FSoftObjectPath>& inPaths)
+{
+	++mNumLoadRequests;
+	return mStreamableManager.RequestAsyncLoad(inPaths, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+}
+
+UPaperSprite* FGameJam2021DeliveryContent::GetGrannySprite() const
+{
+	return (mUpcomingVariants.Num() > 0 ? mVariants[mUpcomingVariants[0]].mGrannySprite.Get() : nullptr);
+}
+
+UPaperSprite* FGameJam2021DeliveryContent::GetThankYouSprite() const
+{
+	return (mUpcomingVariants.Num() > 0 ? mVariants[mUpcomingVariants[0]].mThankYouSprite.Get() : nullptr);
+}
+
+UParticleSystem* FGameJam2021DeliveryContent::GetParticles() const
+{
+	return mParticles.Get();
+}
+
+SIZE_T FGameJam2021DeliveryContent::GetResidentBytes() const
+{
+	// Sprites of a variant usually share their atlas texture, which is only counted once
+	TSet<UObject*> objects;
+	TArray<UObject*> loaded_assets;
+	auto add_loaded_assets = [&objects, &loaded_assets](const TSharedPtr<FStreamableHandle>& inHandle)
+	{
+		if (!inHandle.IsValid())
+			return;
+
+		loaded_assets.Reset();
+		inHandle->GetLoadedAssets(loaded_assets);
+		for (UObject* asset : loaded_assets)
+		{
+			objects.Add(asset);
+			if (const UPaperSprite* sprite = Cast<UPaperSprite>(asset))
+				objects.Add(sprite->GetBakedTexture());
+		}
+	};
+
+	add_loaded_assets(mParticlesHandle);
+	for (const TPair<int, TSharedPtr<FStreamableHandle>>& handle : mHandles)
+		add_loaded_assets(handle.Value);
+
+	SIZE_T resident_bytes = 0;
+	for (UObject* object : objects)
+	{
+		if (object)
+			resident_bytes += object->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+	}
+	return resident_bytes;
+}
@@ -0,0 +1,69 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "GameJam2021DeliveryContent.generated.h"
+
+class UPaperSprite;
+class UParticleSystem;
+
+// Look of one delivery, referenced softly so only the ones of the upcoming deliveries have to be loaded
+USTRUCT(BlueprintType)
+struct FGameJam2021DeliveryVariant
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere)
+	TSoftObjectPtr<UPaperSprite> mGrannySprite;
+
+	UPROPERTY(EditAnywhere)
+	TSoftObjectPtr<UPaperSprite> mThankYouSprite;
+};
+
+// Streams the delivery variants in with FStreamableManager ahead of the deliveries that show them. The variants of
+// the current delivery and of the next few ones are picked in advance and kept loaded, every other variant is left
+// to garbage collection. The delivery particles are the same for every delivery and stay loaded.
+class FGameJam2021DeliveryContent
+{
+public:
+	~FGameJam2021DeliveryContent();
+
+	void Initialize(const TArray<FGameJam2021DeliveryVariant>& inVariants, const TSoftObjectPtr<UParticleSystem>& inParticles, const int inNumUpcomingDeliveries, const uint32 inSeed);
+	void Shutdown();
+
+	// Moves on to the next delivery. inOnLoaded is called once its content is loaded, right away if it already is.
+	void AdvanceDelivery(TFunction<void()> inOnLoaded);
+
+	// Null until loaded, or when the variant has none
+	UPaperSprite* GetGrannySprite() const;
+	UPaperSprite* GetThankYouSprite() const;
+	UParticleSystem* GetParticles() const;
+
+	int GetNumResidentVariants() const { return mHandles.Num(); }
+	int GetNumLoadRequests() const { return mNumLoadRequests; }
+	int GetNumLateLoads() const { return mNumLateLoads; }
+
+	// Estimated size of the loaded delivery content, textures included
+	SIZE_T GetResidentBytes() const;
+
+private:
+	void UpdateResidentVariants();
+	TSharedPtr<FStreamableHandle> RequestLoad(const TArray<FSoftObjectPath>& inPaths);
+
+	FStreamableManager mStreamableManager;
+	TArray<FGameJam2021DeliveryVariant> mVariants;
+	TSoftObjectPtr<UParticleSystem> mParticles;
+	TSharedPtr<FStreamableHandle> mParticlesHandle;
+
+	// Variant of the current delivery first, then of the upcoming ones
+	TArray<int> mUpcomingVariants;
+	TMap<int, TSharedPtr<FStreamableHandle>> mHandles;
+	FRandomStream mRandomStream;
+	int mNumUpcomingDeliveries = 0;
+	int mNumDeliveries = 0;
+
+	int mNumLoadRequests = 0;
+	int mNumLateLoads = 0;
+};
@@ -0,0 +1,165 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021DeliveryQueue.h"
+#include "Async/Async.h"
+#include "GameJam2021Stats.h"
+
+FGameJam2021DeliveryQueue::~FGameJam2021DeliveryQueue()
+{
+	Shutdown();
+}
+
+void FGameJam2021DeliveryQueue::Initialize(const int inGridSize, const int inNumQueuedDeliveries, const uint32 inSeed)
+{
+	Shutdown();
+
+	mQueue = MakeUnique<TCircularQueue<FQueuedDelivery>>(FMath::Max(inNumQueuedDeliveries, 1) + 1);
+	mGenerator.SetGridSize(inGridSize);
+	mSeed = inSeed;
+	mNumRestarts = 0;
+	mStopRequested = false;
+	mIsStarted = false;
+	mNumPopped = 0;
+	mNumEmptyFallbacks = 0;
+	mNumMismatches = 0;
+}
+
+void FGameJam2021DeliveryQueue::Shutdown()
+{
+	mStopRequested = true;
+	WaitForWorker();
+	mIsStarted = false;
+}
+
+bool FGameJam2021DeliveryQueue::Pop(const FRouteState& inStartState, const int inNumDirections, FDeliveryRoute& outRoute, const bool inWaitForWorker)
+{
+	if (inWaitForWorker)
+		WaitForWorker();
+
+	const FQueuedDelivery* queued_delivery = (mQueue ? mQueue->Peek() : nullptr);
+	if (!queued_delivery)
+	{
+		++mNumEmptyFallbacks;
+		return false;
+	}
+
+	const FRouteState& queued_start_state = queued_delivery->mStartState;
+	if (queued_start_state.mGridPosition != inStartState.mGridPosition || queued_start_state.mBuildingSide != inStartState.mBuildingSide ||
+		queued_start_state.mFacingDirection != inStartState.mFacingDirection || queued_delivery->mNumDirections != inNumDirections)
+	{
+		// Every later delivery is chained to this one, so none of them is any good either
+		++mNumMismatches;
+		return false;
+	}
+
+	outRoute = queued_delivery->mRoute;
+	mQueue->Dequeue();
+	++mNumPopped;
+	Kick();
+	return true;
+}
+
+void FGameJam2021DeliveryQueue::Restart(const FRouteState& inStartState, const float inTimeAllowance)
+{
+	if (!mQueue)
+		return;
+
+	WaitForWorker();
+	mQueue->Empty();
+
+	// Reseeded on every restart, so the routes do not depend on how many the worker had generated before it
+	mGenerator.SetSeed(mSeed ^ (static_cast<uint32>(++mNumRestarts) * 0x9E3779B9u));
+	mNextStartState = inStartState;
+	mNextTimeAllowance = inTimeAllowance;
+	mIsStarted = true;
+	Kick();
+}
+
+int FGameJam2021DeliveryQueue::GetRouteLength(const float inTimeAllowance)
+{
+	return FMath::Clamp(int(30 - inTimeAllowance) / 3, 2, int(FDeliveryRoute::MaxDirections));
+}
+
+float FGameJam2021DeliveryQueue::GetNextTimeAllowance(const float inTimeAllowance)
+{
+	return FMath::Max(inTimeAllowance - 1.0f, 12.0f);
+}
+
+FGameJam2021DeliveryQueue::FRouteState FGameJam2021DeliveryQueue::PredictNextStartState(const FDeliveryRoute& inRoute)
+{
+	// The player arrives riding along the street of the delivery building, and leaves it the same way
+	return inRoute.mEndState;
+}
+
+void FGameJam2021DeliveryQueue::Kick()
+{
+	if (!mIsStarted || mStopRequested || mQueue->IsFull())
+		return;
+
+	// A running worker is asked to go on instead, so there is never more than one
+	uint8 worker_state = mWorkerState.load();
+	for (;;)
+	{
+		if (worker_state == WorkerRefillRequested)
+			return;
+
+		const uint8 next_worker_state = (worker_state == WorkerIdle ? WorkerRunning : WorkerRefillRequested);
+		if (mWorkerState.compare_exchange_weak(worker_state, next_worker_state))
+		{
+			if (next_worker_state == WorkerRefillRequested)
+				return;
+			break;
+		}
+	}
+
+	// The previous worker set the state to idle as the last thing it did, it is only left to return
+	WaitForWorker();
+	mWorkerTask = Async(EAsyncExecution::TaskGraph, [this]() { Produce(); });
+}
+
+void FGameJam2021DeliveryQueue::Produce()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FGameJam2021DeliveryQueue::Produce);
+
+	for (;;)
+	{
+		bool is_route_failed = false;
+		while (!mStopRequested && !mQueue->IsFull())
+		{
+			FQueuedDelivery queued_delivery;
+			queued_delivery.mStartState = mNextStartState;
+			queued_delivery.mNumDirections = GetRouteLength(mNextTimeAllowance);
+			const bool is_route_generated = mGenerator.GenerateRoute(queued_delivery.mStartState, queued_delivery.mNumDirections, queued_delivery.mRoute);
+			INC_DWORD_STAT_BY(STAT_RemembikeRouteStatesVisited, mGenerator.GetDistanceField().GetNumVisitedStates());
+			INC_DWORD_STAT_BY(STAT_RemembikeRouteMovesRejected, mGenerator.GetDistanceField().GetNumRejectedMoves());
+			if (!is_route_generated)
+			{
+				is_route_failed = true; // Left to the synchronous fallback, which also handles a failed route
+				break;
+			}
+
+			mNextStartState = PredictNextStartState(queued_delivery.mRoute);
+			mNextTimeAllowance = GetNextTimeAllowance(mNextTimeAllowance);
+			mQueue->Enqueue(queued_delivery);
+		}
+
+		// A Pop since the last IsFull check asked for a refill, which this worker does instead of a second one.
+		// Nothing of the queue is touched after the state is set to idle.
+		uint8 worker_state = WorkerRunning;
+		if (is_route_failed || mStopRequested || mWorkerState.compare_exchange_strong(worker_state, WorkerIdle))
+		{
+			mWorkerState = WorkerIdle;
+			return;
+		}
+		mWorkerState = WorkerRunning;
+	}
+}
+
+void FGameJam2021DeliveryQueue::WaitForWorker()
+{
+	if (mWorkerTask.IsValid())
+	{
+		mWorkerTask.Wait();
+		mWorkerTask.Reset();
+	}
+}
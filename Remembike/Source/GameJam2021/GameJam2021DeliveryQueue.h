@@ -0,0 +1,79 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Containers/CircularQueue.h"
+#include "RouteCore/RouteGenerator.h"
+
+// Deliveries generated ahead of time on a task graph worker. Every queued delivery starts where the previous one is
+// predicted to end, so the game thread only has to check that prediction and pop. The worker is the only producer
+// and the game thread the only consumer of the lock-free queue. The worker generator has no route trace, only the
+// synchronous fallbacks show up in DumpRouteTrace.
+class FGameJam2021DeliveryQueue
+{
+public:
+	using FRouteState = RouteCore::FRouteState;
+	using FDeliveryRoute = RouteCore::FDeliveryRoute;
+
+	~FGameJam2021DeliveryQueue();
+
+	void Initialize(const int inGridSize, const int inNumQueuedDeliveries, const uint32 inSeed);
+	void Shutdown();
+
+	// Pops the next delivery if it starts at inStartState with inNumDirections streets. If it does not, the queue
+	// was generated for a different start and nothing is popped, the caller has to generate the route itself and
+	// Restart the queue from it.
+	// With inWaitForWorker the worker is waited for first, so whether a delivery is popped does not depend on how far
+	// it got, which recordings and replays need to get the same routes.
+	bool Pop(const FRouteState& inStartState, const int inNumDirections, FDeliveryRoute& outRoute, const bool inWaitForWorker = false);
+
+	// Empties the queue and starts generating again after a route that did not come from it
+	void Restart(const FRouteState& inStartState, const float inTimeAllowance);
+
+	// Difficulty curve, the time allowance of every delivery shrinks until it reaches its minimum and routes get longer
+	static int GetRouteLength(const float inTimeAllowance);
+	static float GetNextTimeAllowance(const float inTimeAllowance);
+	static FRouteState PredictNextStartState(const FDeliveryRoute& inRoute);
+
+	int GetNumPopped() const { return mNumPopped; }
+	int GetNumEmptyFallbacks() const { return mNumEmptyFallbacks; }
+	int GetNumMismatches() const { return mNumMismatches; }
+
+private:
+	struct FQueuedDelivery
+	{
+		FRouteState mStartState;
+		int mNumDirections = 0;
+		FDeliveryRoute mRoute;
+	};
+
+	void Kick();
+	void Produce();
+	void WaitForWorker();
+
+	TUniquePtr<TCircularQueue<FQueuedDelivery>> mQueue;
+	TFuture<void> mWorkerTask;
+	enum EWorkerState : uint8
+	{
+		WorkerIdle,
+		WorkerRunning,
+		WorkerRefillRequested // Running, and a Pop asked for another pass once the queue is full
+	};
+	std::atomic<uint8> mWorkerState { WorkerIdle };
+	std::atomic<bool> mStopRequested { false };
+
+	// Only touched by the worker while it runs, and by the game thread while it does not
+	RouteCore::FRouteGenerator mGenerator;
+	uint32 mSeed = 0;
+	int mNumRestarts = 0;
+	FRouteState mNextStartState;
+	float mNextTimeAllowance = 0.0f;
+	bool mIsStarted = false;
+
+	int mNumPopped = 0;
+	int mNumEmptyFallbacks = 0;
+	int mNumMismatches = 0;
+};
@@ -1,7 +1,7 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#include "GameJam2021GameMode.h"
-
-AGameJam2021GameMode::AGameJam2021GameMode()
-{
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021GameMode.h"
+
+AGameJam2021GameMode::AGameJam2021GameMode()
+{
 }
\ No newline at end of file
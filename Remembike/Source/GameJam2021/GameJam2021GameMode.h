@@ -1,19 +1,19 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "GameFramework/GameModeBase.h"
-#include "GameJam2021GameMode.generated.h"
-
-UCLASS(minimalapi)
-class AGameJam2021GameMode : public AGameModeBase
-{
-	GENERATED_BODY()
-
-public:
-	AGameJam2021GameMode();
-};
-
-
-
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameJam2021GameMode.generated.h"
+
+UCLASS(minimalapi)
+class AGameJam2021GameMode : public AGameModeBase
+{
+	GENERATED_BODY()
+
+public:
+	AGameJam2021GameMode();
+};
+
+
+
@@ -0,0 +1,51 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameJam2021HudState.generated.h"
+
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class EGameJam2021HudField : uint8
+{
+	None = 0 UMETA(Hidden),
+	RemainingTime = 1 << 0,
+	AnimationRate = 1 << 1,
+	ArrowsOpacity = 1 << 2
+};
+ENUM_CLASS_FLAGS(EGameJam2021HudField);
+
+// Everything the HUD and the bike animation show every frame, already quantized to what can be told apart on screen,
+// so comparing two states tells whether the HUD has to be updated at all
+USTRUCT(BlueprintType)
+struct FGameJam2021HudState
+{
+	GENERATED_BODY()
+
+	// Whole seconds, rounded up so the timer shows 0 only when the time is over
+	UPROPERTY(BlueprintReadOnly)
+	int32 mRemainingSeconds = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	float mAnimationRate = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float mArrowsOpacity = 0.0f;
+
+	EGameJam2021HudField GetChangedFields(const FGameJam2021HudState& inPreviousState) const
+	{
+		EGameJam2021HudField changed_fields = EGameJam2021HudField::None;
+		if (mRemainingSeconds != inPreviousState.mRemainingSeconds)
+			changed_fields |= EGameJam2021HudField::RemainingTime;
+		if (mAnimationRate != inPreviousState.mAnimationRate)
+			changed_fields |= EGameJam2021HudField::AnimationRate;
+		if (mArrowsOpacity != inPreviousState.mArrowsOpacity)
+			changed_fields |= EGameJam2021HudField::ArrowsOpacity;
+		return changed_fields;
+	}
+
+	static float Quantize(const float inValue, const int inNumSteps)
+	{
+		return FMath::RoundToFloat(inValue * inNumSteps) / inNumSteps;
+	}
+};
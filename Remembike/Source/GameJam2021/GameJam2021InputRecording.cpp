@@ -0,0 +1,102 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021InputRecording.h"
+#include "GameJam2021.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+void FGameJam2021InputRecording::BeginRecording(const FString& inFilePath, const uint32 inSeed)
+{
+	mFilePath = inFilePath;
+	mSeed = inSeed;
+	mFrames.Reset();
+	mFrames.Reserve(60 * 60 * 10); // Ten minutes at 60 fps
+	mIsRecording = true;
+	mIsReplaying = false;
+}
+
+void FGameJam2021InputRecording::RecordFrame(const uint8 inInputBits, const float inDeltaTime)
+{
+	if (!mIsRecording)
+		return;
+
+	FFrame& frame = mFrames.AddDefaulted_GetRef();
+	frame.mInputBits = inInputBits;
+	frame.mDeltaTime = inDeltaTime;
+}
+
+bool FGameJam2021InputRecording::EndRecording()
+{
+	if (!mIsRecording)
+		return false;
+	mIsRecording = false;
+
+	TArray<uint8> file_data;
+	file_data.Reserve(sizeof(uint32) * 4 + mFrames.Num() * (sizeof(uint8) + sizeof(float)));
+	FMemoryWriter writer(file_data);
+
+	uint32 magic = FileMagic;
+	uint32 version = FileVersion;
+	uint32 num_frames = static_cast<uint32>(mFrames.Num());
+	writer << magic << version << mSeed << num_frames;
+	for (FFrame& frame : mFrames)
+		writer << frame.mInputBits << frame.mDeltaTime;
+
+	if (!FFileHelper::SaveArrayToFile(file_data, *mFilePath))
+	{
+		UE_LOG(LogRemembike, Error, TEXT("Could not save the input recording to %s"), *mFilePath);
+		return false;
+	}
+
+	UE_LOG(LogRemembike, Display, TEXT("Saved %d frames of input with seed %u to %s"), mFrames.Num(), mSeed, *mFilePath);
+	return true;
+}
+
+bool FGameJam2021InputRecording::BeginReplay(const FString& inFilePath, uint32& outSeed)
+{
+	mIsRecording = false;
+	mIsReplaying = false;
+	mFrames.Reset();
+	mNextReplayFrame = 0;
+
+	TArray<uint8> file_data;
+	if (!FFileHelper::LoadFileToArray(file_data, *inFilePath))
+	{
+		UE_LOG(LogRemembike, Error, TEXT("Could not load the input recording %s"), *inFilePath);
+		return false;
+	}
+
+	FMemoryReader reader(file_data);
+	uint32 magic = 0;
+	uint32 version = 0;
+	uint32 num_frames = 0;
+	reader << magic << version << mSeed << num_frames;
+	if (magic != FileMagic || version < 1 || version > FileVersion || reader.IsError() ||
+		static_cast<int64>(num_frames) * (sizeof(uint8) + sizeof(float)) > reader.TotalSize() - reader.Tell())
+	{
+		UE_LOG(LogRemembike, Error, TEXT("%s is not a valid input recording"), *inFilePath);
+		return false;
+	}
+
+	mFrames.SetNum(num_frames);
+	for (FFrame& frame : mFrames)
+		reader << frame.mInputBits << frame.mDeltaTime;
+
+	mFilePath = inFilePath;
+	mIsReplaying = true;
+	outSeed = mSeed;
+	UE_LOG(LogRemembike, Display, TEXT("Replaying %d frames of input with seed %u from %s"), mFrames.Num(), mSeed, *mFilePath);
+	return true;
+}
+
+bool FGameJam2021InputRecording::ReplayFrame(uint8& outInputBits, float& outDeltaTime)
+{
+	if (!mIsReplaying || !HasNextReplayFrame())
+		return false;
+
+	const FFrame& frame = mFrames[mNextReplayFrame++];
+	outInputBits = frame.mInputBits;
+	outDeltaTime = frame.mDeltaTime;
+	return true;
+}
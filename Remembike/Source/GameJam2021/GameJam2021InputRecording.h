@@ -0,0 +1,54 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Per-frame record of the bike controls and frame time, plus the seed of the session, so a session can be played
+// back exactly. Kept in memory while playing and saved or loaded as a whole:
+//   uint32 magic, uint32 version, uint32 seed, uint32 number of frames, then per frame uint8 input bits and float delta time
+// The input bits are the buttons held at the end of the frame, and since version 2 the same bits shifted by
+// TapBitsShift are the buttons pressed and released within the frame.
+class FGameJam2021InputRecording
+{
+public:
+	enum EInputBits : uint8
+	{
+		GoForwardBit = 1 << 0,
+		GoBackBit = 1 << 1,
+		TurnLeftBit = 1 << 2,
+		TurnRightBit = 1 << 3
+	};
+	static constexpr int TapBitsShift = 4;
+
+	void BeginRecording(const FString& inFilePath, const uint32 inSeed);
+	void RecordFrame(const uint8 inInputBits, const float inDeltaTime);
+	bool EndRecording();
+
+	// Loads the whole file, outSeed is the seed the session was recorded with
+	bool BeginReplay(const FString& inFilePath, uint32& outSeed);
+	bool ReplayFrame(uint8& outInputBits, float& outDeltaTime);
+	bool HasNextReplayFrame() const { return mNextReplayFrame < mFrames.Num(); }
+	float GetNextReplayDeltaTime() const { return mFrames[mNextReplayFrame].mDeltaTime; }
+
+	bool IsRecording() const { return mIsRecording; }
+	bool IsReplaying() const { return mIsReplaying; }
+	int GetNumFrames() const { return mFrames.Num(); }
+
+private:
+	static constexpr uint32 FileMagic = 0x4B424D52; // "RMBK"
+	static constexpr uint32 FileVersion = 2;
+
+	struct FFrame
+	{
+		uint8 mInputBits = 0;
+		float mDeltaTime = 0.0f;
+	};
+
+	FString mFilePath;
+	uint32 mSeed = 0;
+	TArray<FFrame> mFrames;
+	int mNextReplayFrame = 0;
+	bool mIsRecording = false;
+	bool mIsReplaying = false;
+};
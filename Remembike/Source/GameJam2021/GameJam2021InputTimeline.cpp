@@ -0,0 +1,81 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021InputTimeline.h"
+
+void FGameJam2021InputTimeline::Reset()
+{
+	*this = FGameJam2021InputTimeline();
+}
+
+void FGameJam2021InputTimeline::Press(const EButton inButton, const double inTime)
+{
+	if (mIsHeld[inButton])
+		return;
+
+	mIsHeld[inButton] = true;
+	mIsPressedThisFrame[inButton] = true;
+	mPressTimes[inButton] = (mIsFrameStarted ? FMath::Max(inTime, mFrameStartTime) : inTime);
+}
+
+void FGameJam2021InputTimeline::Release(const EButton inButton, const double inTime)
+{
+	if (!mIsHeld[inButton])
+		return;
+
+	mIsHeld[inButton] = false;
+	mHeldSeconds[inButton] += FMath::Max(inTime - mPressTimes[inButton], 0.0);
+	mIsTapped[inButton] |= mIsPressedThisFrame[inButton];
+}
+
+void FGameJam2021InputTimeline::EndFrame(const double inTime, const float inGameDeltaTime, const float inMinTapSeconds)
+{
+	// Game seconds per wall clock second this frame, which covers time dilation and fixed time steps
+	const double frame_seconds = (mIsFrameStarted ? inTime - mFrameStartTime : 0.0);
+	const double game_time_scale = (frame_seconds > 0.0 ? inGameDeltaTime / frame_seconds : 0.0);
+
+	for (int button_i = 0; button_i < NumButtons; ++button_i)
+	{
+		if (mIsHeld[button_i])
+		{
+			mHeldSeconds[button_i] += FMath::Max(inTime - mPressTimes[button_i], 0.0);
+			mPressTimes[button_i] = inTime;
+		}
+
+		float held_seconds = static_cast<float>(FMath::Min(mHeldSeconds[button_i] * game_time_scale, static_cast<double>(inGameDeltaTime)));
+		if (mIsTapped[button_i])
+			held_seconds = FMath::Max(held_seconds, inMinTapSeconds);
+		mPendingSeconds[button_i] += held_seconds;
+
+		mHeldSeconds[button_i] = 0.0;
+		mIsPressedThisFrame[button_i] = false;
+		mIsTapped[button_i] = false;
+	}
+
+	mFrameStartTime = inTime;
+	mIsFrameStarted = true;
+}
+
+float FGameJam2021InputTimeline::ConsumeButton(const EButton inButton, const float inStepSeconds)
+{
+	const float consumed_seconds = FMath::Min(mPendingSeconds[inButton], inStepSeconds);
+	mPendingSeconds[inButton] -= consumed_seconds;
+	return consumed_seconds / inStepSeconds;
+}
+
+float FGameJam2021InputTimeline::ConsumeThrottle(const float inStepSeconds)
+{
+	const float buttons = ConsumeButton(GoForward, inStepSeconds) - ConsumeButton(GoBack, inStepSeconds);
+	return FMath::Clamp(buttons + mThrottle, -1.0f, 1.0f);
+}
+
+float FGameJam2021InputTimeline::ConsumeSteering(const float inStepSeconds)
+{
+	const float buttons = ConsumeButton(TurnRight, inStepSeconds) - ConsumeButton(TurnLeft, inStepSeconds);
+	return FMath::Clamp(buttons + mSteering, -1.0f, 1.0f);
+}
+
+void FGameJam2021InputTimeline::ClampPending(const float inMaxSeconds)
+{
+	for (float& pending_seconds : mPendingSeconds)
+		pending_seconds = FMath::Min(pending_seconds, inMaxSeconds);
+}
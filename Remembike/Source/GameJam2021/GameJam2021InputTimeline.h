@@ -0,0 +1,64 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Press and release times of the bike buttons, plus the analog steering and throttle, turned into how long each
+// control was held during every simulation step. Held time is measured between the timestamps of the events
+// instead of sampling the buttons once per frame, so a tap shorter than a frame still moves the bike, for at least
+// the minimum tap time. Times are FPlatformTime::Seconds, held time is converted to game time frame by frame.
+class FGameJam2021InputTimeline
+{
+public:
+	enum EButton : uint8
+	{
+		GoForward,
+		GoBack,
+		TurnLeft,
+		TurnRight,
+		NumButtons
+	};
+
+	void Reset();
+
+	void Press(const EButton inButton, const double inTime);
+	void Release(const EButton inButton, const double inTime);
+	bool IsHeld(const EButton inButton) const { return mIsHeld[inButton]; }
+
+	// Pressed and released since the last EndFrame
+	bool WasTapped(const EButton inButton) const { return mIsTapped[inButton]; }
+
+	// In [-1, 1], held until changed
+	void SetSteering(const float inSteering) { mSteering = FMath::Clamp(inSteering, -1.0f, 1.0f); }
+	void SetThrottle(const float inThrottle) { mThrottle = FMath::Clamp(inThrottle, -1.0f, 1.0f); }
+
+	// Adds the time every button was held since the previous frame, inGameDeltaTime being the game time this frame
+	// advances. Events timestamped before the previous frame ended count from its end.
+	void EndFrame(const double inTime, const float inGameDeltaTime, const float inMinTapSeconds);
+	double GetFrameStartTime() const { return mFrameStartTime; }
+
+	// Controls over the next step, in [-1, 1]: the held fraction of the step of the buttons plus the analog axis.
+	// Held time the steps do not consume yet is left for the next ones.
+	float ConsumeThrottle(const float inStepSeconds);
+	float ConsumeSteering(const float inStepSeconds);
+
+	// Drops the held time beyond inMaxSeconds, for when the frame was longer than the steps it could run
+	void ClampPending(const float inMaxSeconds);
+
+private:
+	float ConsumeButton(const EButton inButton, const float inStepSeconds);
+
+	double mFrameStartTime = 0.0;
+	bool mIsFrameStarted = false;
+	float mSteering = 0.0f;
+	float mThrottle = 0.0f;
+
+	// Per button
+	bool mIsHeld[NumButtons] = {};
+	bool mIsPressedThisFrame[NumButtons] = {};
+	bool mIsTapped[NumButtons] = {};
+	double mPressTimes[NumButtons] = {};
+	double mHeldSeconds[NumButtons] = {}; // Wall clock, since the start of the frame
+	float mPendingSeconds[NumButtons] = {}; // Game time not consumed by steps yet
+};
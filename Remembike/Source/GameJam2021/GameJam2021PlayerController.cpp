@@ -1,528 +1,1250 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#include "GameJam2021PlayerController.h"
-#include "Engine/World.h"
-#include "DrawDebugHelpers.h"
-
-AGameJam2021PlayerController::AGameJam2021PlayerController()
-{
-	bShowMouseCursor = false;
-}
-
-void AGameJam2021PlayerController::InitializeOnFirstTick()
-{
-	mCharacter = Cast<ACharacter>( GetPawn() );
-
-	for (int y = 0; y < BuildingArraySize; ++y)
-	{
-		for (int x = 0; x < BuildingArraySize; ++x)
-		{
-			const FVector building_position = GetGridWorldPosition( FVector2D(x, y) );
-			if (!mBPBuildingClass)
-				continue;
-
-			mBuildings.at(y).at(x) = GetWorld()->SpawnActor<AActor>(mBPBuildingClass, building_position, FRotator()); // Spawn object
-			// mBuildings.at(y).at(x)->SetActorLabel("Building_" + FString::FromInt(x) + "_" + FString::FromInt(y));
-
-			TArray<UChildActorComponent*> building_child_actor_components;
-			mBuildings.at(y).at(x)->GetComponents<UChildActorComponent>(building_child_actor_components, true);
-			for (UChildActorComponent* building_child_actor_comp : building_child_actor_components)
-				building_child_actor_comp->GetChildActor()->SetActorHiddenInGame(true);
-		}
-	}
-
-	for (int y = -1; y <= BuildingArraySize; ++y)
-	{
-		for (int x : { -1 , BuildingArraySize })
-		{
-			const FVector building_position = GetGridWorldPosition(FVector2D(x, y));
-			if (!mBPBarrierClass)
-				continue;
-			AActor *barrier = GetWorld()->SpawnActor<AActor>(mBPBarrierClass, building_position, FRotator());
-			barrier->SetActorRotation(FRotator(0, x == -1 ? 180 : 0, 0));
-		}
-	}
-
-	for (int x = -1; x <= BuildingArraySize; ++x)
-	{
-		for (int y : { -1, BuildingArraySize })
-		{
-			const FVector building_position = GetGridWorldPosition(FVector2D(x, y));
-			if (!mBPBarrierClass)
-				continue;
-			AActor* barrier = GetWorld()->SpawnActor<AActor>(mBPBarrierClass, building_position, FRotator());
-			barrier->SetActorRotation(FRotator(0, y == -1 ? 90 : -90, 0));
-		}
-	}
-
-
-
-	TArray<USceneComponent*> scene_comps;
-	mCharacter->GetComponents<USceneComponent>(scene_comps, true);
-	GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, FString::FromInt(scene_comps.Num()));
-	for (USceneComponent* scene_comp : scene_comps)
-	{
-		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, scene_comp->GetName());
-		if (scene_comp->ComponentHasTag("RotationActor"))
-		{
-			mRotationComp = scene_comp;
-			break;
-		}
-	}
-	ensure(mRotationComp != nullptr);
-
-	TArray<UCapsuleComponent*> capsules;
-	mCharacter->GetComponents(capsules, true);
-	ensure(capsules.Num() >= 1);
-	mCharacterCapsule = capsules[0];
-
-	mNextDeliveryGridPosition = FVector2D(BuildingArraySize / 2, BuildingArraySize / 2);
-	mNextDeliveryBuildingSide = EDirection::RIGHT; // Initial;
-	GenerateNextDelivery(EDirection::FORWARD, true);
-}
-
-void AGameJam2021PlayerController::PlayerTick(float inDeltaTime)
-{
-	Super::PlayerTick(inDeltaTime);
-
-	if (mFirstTick)
-	{
-		mFirstTick = false;
-		InitializeOnFirstTick();
-	}
-
-	mRemainingTime -= inDeltaTime;
-	if (mRemainingTime < 0.0f)
-		GoToLoseScreen();
-	SetRemainingTime(mRemainingTime);
-
-	if (mIsStunned)
-	{
-		mTimeStunned += inDeltaTime;
-		if (mTimeStunned >= mStunTime)
-		{
-			mIsStunned = false;
-			mTimeStunned = 0.0f;
-		}
-	}
-
-	if (mTimeSinceShowArrows < mShowArrowsTime && mDirectionArrowsOpacityCurve)
-	{
-		mTimeSinceShowArrows += inDeltaTime;
-		const float norm_time = FMath::Min(mTimeSinceShowArrows / mShowArrowsTime, 1.0f);
-		const float opacity = mDirectionArrowsOpacityCurve->GetFloatValue(norm_time);
-		SetDirectionArrowsOpacity(opacity);
-	}
-
-	// GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, "DoGoAnimation");
-
-	const float animation_rate = mCharacter->GetVelocity().Size() / mCharacter->GetCharacterMovement()->GetMaxSpeed();
-	SetAnimationRate(animation_rate);
-
-	if (!mIsStunned)
-	{
-		if (mGoingForward)
-			mCharacter->AddMovementInput(mCharacter->GetActorForwardVector(), mForwardSpeed * inDeltaTime);
-		if (mGoingBack)
-			mCharacter->AddMovementInput(mCharacter->GetActorForwardVector(), -mForwardSpeed * inDeltaTime);
-		
-		if (mTurningLeft)
-			ControlRotation = FRotator(0, ControlRotation.Yaw - mTurnSpeed * inDeltaTime, 0);
-		if (mTurningRight)
-			ControlRotation = FRotator(0, ControlRotation.Yaw + mTurnSpeed * inDeltaTime, 0);
-	}
-
-	// GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, mCharacter->GetActorRotation().ToString() );
-}
-
-void AGameJam2021PlayerController::OnDeliveryMade()
-{
-	GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, "OnDeliveryMade()");
-
-	ShowThankDelivery();
-
-	EDirection start_dir = EDirection::FORWARD;
-	if (mNextDeliveryBuildingSide == EDirection::FORWARD || mNextDeliveryBuildingSide == EDirection::BACK)
-		start_dir = mCharacter->GetActorRotation().Yaw < 0 ? EDirection::LEFT : EDirection::RIGHT;
-	else
-		start_dir = FMath::Abs(mCharacter->GetActorRotation().Yaw) < 90 ? EDirection::FORWARD : EDirection::BACK;
-
-	// Reset rotation
-	/*
-	float yaw = 0.0f;
-	switch (start_dir)
-	{
-	case EDirection::FORWARD: yaw = 0.0f; break;
-	case EDirection::BACK: yaw = 180.0f; break;
-	case EDirection::LEFT: yaw = -90.0f; break;
-	case EDirection::RIGHT: yaw = 90.0f; break;
-	}
-	ControlRotation = FRotator(0, yaw, 0);
-	*/
-
-	GenerateNextDelivery(start_dir);
-}
-
-void AGameJam2021PlayerController::OnStunned()
-{
-	mIsStunned = true;
-	mTimeStunned = 0.0f;
-}
-
-FVector AGameJam2021PlayerController::GetGridWorldPosition(const FVector2D& inGridPositionInt) const
-{
-	const FVector transposed_grid_pos_int = FVector(inGridPositionInt.Y, inGridPositionInt.X, 0);
-	return transposed_grid_pos_int * mBuildingSize - FVector(BuildingArraySize / 2, BuildingArraySize / 2, 0) * mBuildingSize;
-}
-
-FVector AGameJam2021PlayerController::GetGridWorldPosition(const FVector2D& inGridPositionInt, const EDirection& inBuildingSide) const
-{
-	const FVector world_pos = GetGridWorldPosition(inGridPositionInt);
-	const FVector2D dir_vector = GetDirectionVector(inBuildingSide);
-	return world_pos + FVector(dir_vector.Y, dir_vector.X, 0) * mBuildingSize * 0.35f;
-}
-
-FVector2D AGameJam2021PlayerController::GetDirectionVector(const EDirection& inDirection) const
-{
-	switch (inDirection)
-	{
-		case EDirection::FORWARD: return FVector2D(0, 1);
-		case EDirection::BACK: return FVector2D(0, -1);
-		case EDirection::LEFT: return FVector2D(-1, 0);
-		default: return FVector2D(1, 0);
-	}
-}
-
-FString AGameJam2021PlayerController::GetDirectionString(const EDirection& inDirection) const
-{
-	switch (inDirection)
-	{
-		case EDirection::FORWARD: return FString("FORWARD");
-		case EDirection::BACK: return FString("BACK");
-		case EDirection::LEFT: return FString("LEFT");
-		default: return FString("RIGHT");
-	}
-}
-
-AGameJam2021PlayerController::EDirection AGameJam2021PlayerController::GetOppositeDirection(const EDirection& inDirection) const
-{
-	switch (inDirection)
-	{
-		case EDirection::FORWARD: return EDirection::BACK;
-		case EDirection::BACK: return EDirection::FORWARD;
-		case EDirection::LEFT: return EDirection::RIGHT;
-		default: return EDirection::LEFT;
-	}
-}
-
-void AGameJam2021PlayerController::GenerateNextDelivery(const EDirection& inStartFaceDirection, const bool inIsFirstDelivery)
-{
-	static int num_recalls = 0;
-	if (++num_recalls == 100)
-		return;
-
-	EDirection current_facing_dir = inStartFaceDirection;
-	EDirection current_building_side = mNextDeliveryBuildingSide;
-	FVector2D current_building_grid_position = mNextDeliveryGridPosition;
-
-	UE_LOG(LogTemp, Warning, TEXT("START FACING DIR: %s"), *GetDirectionString(current_facing_dir));
-	UE_LOG(LogTemp, Warning, TEXT("START BUILDING SIDE: %s"), *GetDirectionString(current_building_side));
-	UE_LOG(LogTemp, Warning, TEXT("START GRID POSITION: %s"), *current_building_grid_position.ToString());
-
-	int try_i = 0;
-	const int num_directions = FMath::Max(int(30 - mPreviousTotalRemainingTime) / 3, 2);
-	int num_tries = 100;
-	std::vector<EDirection> directions;
-	while (directions.size() < num_directions)
-	{
-		const int next_move_direction_int = (rand() % 4);
-		const EDirection next_move_direction = static_cast<EDirection>(next_move_direction_int);
-		if (next_move_direction == EDirection::BACK)
-			continue;
-
-		if (++try_i >= num_tries)
-		{
-			// Start over
-			GenerateNextDelivery(inStartFaceDirection);
-			return;
-		}
-
-		// Avoid taking a direction that would go outside
-		{
-			if (current_building_grid_position.X <= 0)
-			{
-				if (current_facing_dir == EDirection::LEFT && next_move_direction == EDirection::FORWARD) continue;
-				if (current_facing_dir == EDirection::RIGHT && next_move_direction == EDirection::BACK) continue;
-				if (current_facing_dir == EDirection::FORWARD && next_move_direction == EDirection::LEFT) continue;
-				if (current_facing_dir == EDirection::BACK && next_move_direction == EDirection::RIGHT) continue;
-			}
-
-			if (current_building_grid_position.Y <= 0)
-			{
-				if (current_facing_dir == EDirection::FORWARD && next_move_direction == EDirection::BACK) continue;
-				if (current_facing_dir == EDirection::BACK && next_move_direction == EDirection::FORWARD) continue;
-				if (current_facing_dir == EDirection::RIGHT && next_move_direction == EDirection::RIGHT) continue;
-				if (current_facing_dir == EDirection::LEFT && next_move_direction == EDirection::LEFT) continue;
-			}
-
-			if (current_building_grid_position.X >= BuildingArraySize - 1)
-			{
-				if (current_facing_dir == EDirection::RIGHT && next_move_direction == EDirection::FORWARD) continue;
-				if (current_facing_dir == EDirection::LEFT && next_move_direction == EDirection::BACK) continue;
-				if (current_facing_dir == EDirection::FORWARD && next_move_direction == EDirection::RIGHT) continue;
-				if (current_facing_dir == EDirection::BACK && next_move_direction == EDirection::LEFT) continue;
-			}
-
-			if (current_building_grid_position.Y >= BuildingArraySize - 1)
-			{
-				if (current_facing_dir == EDirection::FORWARD && next_move_direction == EDirection::FORWARD) continue;
-				if (current_facing_dir == EDirection::BACK && next_move_direction == EDirection::BACK) continue;
-				if (current_facing_dir == EDirection::RIGHT && next_move_direction == EDirection::LEFT) continue;
-				if (current_facing_dir == EDirection::LEFT && next_move_direction == EDirection::RIGHT) continue;
-			}
-		}
-
-		EDirection new_facing_dir = current_facing_dir;
-		EDirection new_building_side = current_building_side;
-		FVector2D new_building_grid_position = current_building_grid_position;
-		if (next_move_direction == EDirection::FORWARD)
-		{
-			new_facing_dir = current_facing_dir;
-
-			new_building_side = current_building_side;
-
-			new_building_grid_position += GetDirectionVector(current_facing_dir);
-		}
-		else if (next_move_direction == EDirection::BACK)
-		{
-			new_facing_dir = GetOppositeDirection(current_facing_dir);
-
-			new_building_side = current_building_side;
-
-			new_building_grid_position -= GetDirectionVector(current_facing_dir);
-		}
-		else if (next_move_direction == EDirection::LEFT)
-		{
-			if (current_facing_dir == EDirection::FORWARD) new_facing_dir = EDirection::LEFT;
-			else if (current_facing_dir == EDirection::LEFT) new_facing_dir = EDirection::BACK;
-			else if (current_facing_dir == EDirection::BACK) new_facing_dir = EDirection::RIGHT;
-			else new_facing_dir = EDirection::FORWARD;
-
-			new_building_side = (new_facing_dir == EDirection::FORWARD || new_facing_dir == EDirection::BACK) ? EDirection::RIGHT : EDirection::FORWARD;
-
-			if (current_facing_dir == EDirection::FORWARD)
-				new_building_grid_position += (current_building_side == EDirection::RIGHT ? FVector2D(0, 0) : FVector2D(-1, 0));
-			else if (current_facing_dir == EDirection::BACK)
-				new_building_grid_position += (current_building_side == EDirection::RIGHT ? FVector2D(1, -1) : FVector2D(0, -1));
-			else if (current_facing_dir == EDirection::LEFT)
-				new_building_grid_position += (current_building_side == EDirection::FORWARD ? FVector2D(-1, 0) : FVector2D(-1, -1));
-			else if (current_facing_dir == EDirection::RIGHT)
-				new_building_grid_position += (current_building_side == EDirection::FORWARD ? FVector2D(0, 1) : FVector2D(0, 0));
-		}
-		else if (next_move_direction == EDirection::RIGHT)
-		{
-			if (current_facing_dir == EDirection::FORWARD) new_facing_dir = EDirection::RIGHT;
-			else if (current_facing_dir == EDirection::BACK) new_facing_dir = EDirection::LEFT;
-			else if (current_facing_dir == EDirection::LEFT) new_facing_dir = EDirection::FORWARD;
-			else new_facing_dir = EDirection::BACK;
-
-			new_building_side = (new_facing_dir == EDirection::FORWARD || new_facing_dir == EDirection::BACK) ? EDirection::RIGHT : EDirection::FORWARD;
-
-			if (current_facing_dir == EDirection::FORWARD)
-				new_building_grid_position += (current_building_side == EDirection::RIGHT ? FVector2D(1, 0) : FVector2D(0, 0));
-			else if (current_facing_dir == EDirection::BACK)
-				new_building_grid_position += (current_building_side == EDirection::RIGHT ? FVector2D(0, -1) : FVector2D(-1, -1));
-			else if (current_facing_dir == EDirection::LEFT)
-				new_building_grid_position += (current_building_side == EDirection::FORWARD ? FVector2D(-1, 1) : FVector2D(-1, 0));
-			else if (current_facing_dir == EDirection::RIGHT)
-				new_building_grid_position += (current_building_side == EDirection::FORWARD ? FVector2D(0, 0) : FVector2D(0, -1));
-		}
-
-		if (new_building_grid_position.X == -1 && new_building_grid_position.Y == -1)
-			continue;
-
-		if (new_building_grid_position.X == -1)
-		{
-			new_building_grid_position.X = 0;
-			new_building_side = EDirection::LEFT;
-		}
-		else if (new_building_grid_position.Y == -1)
-		{
-			new_building_grid_position.Y = 0;
-			new_building_side = EDirection::BACK;
-		}
-		/*
-		else if (new_facing_dir == EDirection::FORWARD || new_facing_dir == EDirection::BACK)
-			new_building_side = EDirection::RIGHT;
-		else
-			new_building_side = EDirection::FORWARD;
-		*/
-
-		UE_LOG(LogTemp, Warning, TEXT("      try***TURN DIR: %s"), *GetDirectionString(next_move_direction));
-		UE_LOG(LogTemp, Warning, TEXT("         try***NEW FACING DIR: %s"), *GetDirectionString(new_facing_dir));
-		UE_LOG(LogTemp, Warning, TEXT("         try***NEW BUILDING SIDE: %s"), *GetDirectionString(new_building_side));
-		UE_LOG(LogTemp, Warning, TEXT("         try***NEW GRID POSITION: %s"), *new_building_grid_position.ToString());
-
-		if (new_building_grid_position.X < 0 || new_building_grid_position.Y < 0 || new_building_grid_position.X >= BuildingArraySize || new_building_grid_position.Y >= BuildingArraySize)
-			continue;
-
-		UE_LOG(LogTemp, Warning, TEXT("TURN DIR: %s"), *GetDirectionString(next_move_direction));
-		UE_LOG(LogTemp, Warning, TEXT("  NEW FACING DIR: %s"), *GetDirectionString(new_facing_dir));
-		UE_LOG(LogTemp, Warning, TEXT("  NEW BUILDING SIDE: %s"), *GetDirectionString(new_building_side));
-		UE_LOG(LogTemp, Warning, TEXT("  NEW GRID POSITION: %s"), *new_building_grid_position.ToString());
-
-		current_building_grid_position = new_building_grid_position;
-		current_building_side = new_building_side;
-		current_facing_dir = new_facing_dir;
-
-		directions.push_back(next_move_direction);
-	}
-
-	if (current_building_grid_position == mNextDeliveryGridPosition)
-		// FMath::Abs(current_building_grid_position.X - mNextDeliveryGridPosition.X) +
-		// FMath::Abs(current_building_grid_position.Y - mNextDeliveryGridPosition.Y) <= 1 ) // Very close, start over
-	{
-		GenerateNextDelivery(inStartFaceDirection);
-		return;
-	}
-
-	UE_LOG(LogTemp, Warning, TEXT("SUMMARY: ------"));
-	for (const EDirection& dir : directions)
-	{
-		UE_LOG(LogTemp, Warning, TEXT("TURN DIR: %s"), *GetDirectionString(dir));
-	}
-	UE_LOG(LogTemp, Warning, TEXT("BUILDING SIDE: %s"), *GetDirectionString(current_building_side));
-	UE_LOG(LogTemp, Warning, TEXT("GRID POSITION: %s"), *current_building_grid_position.ToString());
-	UE_LOG(LogTemp, Warning, TEXT("=========================="));
-
-	const FVector delivery_world_pos = GetGridWorldPosition(current_building_grid_position, current_building_side);
-	UE_LOG(LogTemp, Warning, TEXT("delivery_world_pos: %s"), *delivery_world_pos.ToString());
-	// DrawDebugLine(GetWorld(), delivery_world_pos, delivery_world_pos + FVector(0, 0, 999999), FColor::Red, true, 15.0f, 0, 100.0f);
-
-	const bool is_delivery_in_boundary = (current_building_grid_position.X == 0 || current_building_grid_position.Y == 0 ||
-		current_building_grid_position.X == BuildingArraySize - 1 ||
-		current_building_grid_position.Y == BuildingArraySize - 1);
-	const bool change_street_side = false; // !is_delivery_in_boundary && (rand() % 2 == 0); NOT WORKING
-	mNextDeliveryBuildingSide = (change_street_side ? GetOppositeDirection(current_building_side) : current_building_side);
-	mNextDeliveryGridPosition = current_building_grid_position + (change_street_side ? GetDirectionVector(current_building_side) : FVector2D(0, 0));
-	verify(mNextDeliveryGridPosition.X >= 0 && mNextDeliveryGridPosition.Y >= 0 && mNextDeliveryGridPosition.X < BuildingArraySize&& mNextDeliveryGridPosition.Y < BuildingArraySize);
-
-	mShowArrowsTime = (mPreviousTotalRemainingTime / 2);
-
-	if (mNextDeliveryTrigger)
-		mNextDeliveryTrigger->SetActorHiddenInGame(true);
-
-	AActor* next_delivery_building = mBuildings.at(mNextDeliveryGridPosition.Y).at(mNextDeliveryGridPosition.X);
-	UE_LOG(LogTemp, Warning, TEXT("mNextDeliveryGridPosition: %s"), *mNextDeliveryGridPosition.ToString());
-	UE_LOG(LogTemp, Warning, TEXT("mNextDeliveryBuildingSide: %s"), *GetDirectionString(mNextDeliveryBuildingSide));
-	verify(next_delivery_building != nullptr);
-	TArray<UChildActorComponent*> next_delivery_building_child_actor_components;
-	next_delivery_building->GetComponents<UChildActorComponent>(next_delivery_building_child_actor_components, true);
-	for (UChildActorComponent* next_delivery_building_child_actor_comp : next_delivery_building_child_actor_components)
-	{
-		UE_LOG(LogTemp, Warning, TEXT("next_delivery_building_child_actor_comp->GetName(): %s"), *next_delivery_building_child_actor_comp->GetName());
-		if (next_delivery_building_child_actor_comp->ComponentHasTag(FName(FString("DeliveryTrigger_") + GetDirectionString(mNextDeliveryBuildingSide))))
-		{
-			mNextDeliveryTrigger = next_delivery_building_child_actor_comp->GetChildActor();
-			UE_LOG(LogTemp, Warning, TEXT("FOUND!"), *next_delivery_building_child_actor_comp->GetName());
-			break;
-		}
-	}
-	verify(mNextDeliveryTrigger != nullptr);
-	mNextDeliveryTrigger->SetActorHiddenInGame(false);
-
-	num_recalls = 0;
-
-	TArray<int> directions_array_for_blueprint;
-	for (const EDirection& direction : directions)
-	{
-		directions_array_for_blueprint.Push(static_cast<int>(direction));
-	}
-
-	mTimeSinceShowArrows = 0.0f;
-	ShowDirectionArrows(directions_array_for_blueprint);
-
-	mRemainingTime = mPreviousTotalRemainingTime - 1.0f; // Reset remaining time
-	mRemainingTime = FMath::Max(mRemainingTime, 12.0f);
-	mPreviousTotalRemainingTime = mRemainingTime;
-	if (!inIsFirstDelivery)
-	{
-		mScore += 100.0f;
-		SetScore(mScore);
-	}
-}
-
-void AGameJam2021PlayerController::OnOverlap(AActor* inOverlappedActor)
-{
-	UE_LOG(LogTemp, Warning, TEXT("OnOverlap with %s"), *inOverlappedActor->GetName());
-	if (mNextDeliveryTrigger)
-	{
-		UE_LOG(LogTemp, Warning, TEXT("mNextDeliveryTrigger->GetNam(): %s"), *mNextDeliveryTrigger->GetName());
-	}
-	else
-	{
-		UE_LOG(LogTemp, Warning, TEXT("mNextDeliveryTrigger is NULL"));
-	}
-
-	if (inOverlappedActor == mNextDeliveryTrigger)
-	{
-		OnDeliveryMade();
-	}
-}
-
-void AGameJam2021PlayerController::SetupInputComponent()
-{
-	// set up gameplay key bindings
-	Super::SetupInputComponent();
-
-	InputComponent->BindAction("GoForward", IE_Pressed, this, &AGameJam2021PlayerController::GoForwardPressed);
-	InputComponent->BindAction("GoBack", IE_Pressed, this, &AGameJam2021PlayerController::GoBackPressed);
-	InputComponent->BindAction("TurnLeft", IE_Pressed, this, &AGameJam2021PlayerController::TurnLeftPressed);
-	InputComponent->BindAction("TurnRight", IE_Pressed, this, &AGameJam2021PlayerController::TurnRightPressed);
-	InputComponent->BindAction("GoForward", IE_Released, this, &AGameJam2021PlayerController::GoForwardReleased);
-	InputComponent->BindAction("GoBack", IE_Released, this, &AGameJam2021PlayerController::GoBackReleased);
-	InputComponent->BindAction("TurnLeft", IE_Released, this, &AGameJam2021PlayerController::TurnLeftReleased);
-	InputComponent->BindAction("TurnRight", IE_Released, this, &AGameJam2021PlayerController::TurnRightReleased);
-
-	FInputActionBinding& toggle = InputComponent->BindAction("Pause", IE_Pressed, this, &AGameJam2021PlayerController::OnPausePressed);
-	toggle.bExecuteWhenPaused = true;
-}
-
-void AGameJam2021PlayerController::GoForwardPressed()
-{
-	mGoingForward = true;
-}
-void AGameJam2021PlayerController::GoBackPressed()
-{
-	mGoingBack = true;
-}
-void AGameJam2021PlayerController::TurnLeftPressed()
-{
-	mTurningLeft = true;
-}
-void AGameJam2021PlayerController::TurnRightPressed()
-{
-	mTurningRight = true;
-}
-
-void AGameJam2021PlayerController::GoForwardReleased()
-{
-	mGoingForward = false;
-}
-void AGameJam2021PlayerController::GoBackReleased()
-{
-	mGoingBack = false;
-}
-void AGameJam2021PlayerController::TurnLeftReleased()
-{
-	mTurningLeft = false;
-}
-void AGameJam2021PlayerController::TurnRightReleased()
-{
-	mTurningRight = false;
-}
-
-void AGameJam2021PlayerController::OnPausePressed()
-{
-	OnPausePressedBP();
-}
\ No newline at end of file
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021PlayerController.h"
+#include "GameJam2021.h"
+#include "GameJam2021Stats.h"
+#include "Engine/World.h"
+#include "DrawDebugHelpers.h"
+#include "EngineUtils.h"
+#include "Misc/App.h"
+#include "Kismet/GameplayStatics.h"
+#include "TimerManager.h"
+#include "PaperSpriteComponent.h"
+#include "PaperFlipbookComponent.h"
+#include "GameJam2021SpriteInstancesComponent.h"
+
+namespace
+{
+	RouteCore::FGridPosition ToGridPosition(const FIntPoint& inGridPosition)
+	{
+		return RouteCore::FGridPosition(inGridPosition.X, inGridPosition.Y);
+	}
+
+	FIntPoint ToIntPoint(const RouteCore::FGridPosition& inGridPosition)
+	{
+		return FIntPoint(inGridPosition.X, inGridPosition.Y);
+	}
+}
+
+AGameJam2021PlayerController::AGameJam2021PlayerController()
+{
+	bShowMouseCursor = false;
+}
+
+void AGameJam2021PlayerController::InitializeOnFirstTick()
+{
+	SCOPE_CYCLE_COUNTER(STAT_RemembikeInitializeOnFirstTick);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AGameJam2021PlayerController::InitializeOnFirstTick);
+	CSV_SCOPED_TIMING_STAT(Remembike, InitializeOnFirstTick);
+
+	mCityBuildStartCycles = FPlatformTime::Cycles64();
+	mCharacter = Cast<ACharacter>( GetPawn() );
+
+	BeginInputRecordingOrReplay();
+
+	FParse::Value(FCommandLine::Get(), TEXT("RemembikeGridSize="), mGridSize);
+	mGridSize = FMath::Clamp(mGridSize, 1, 256);
+
+	FGameJam2021CityGridSettings city_grid_settings;
+	city_grid_settings.mWorld = GetWorld();
+	city_grid_settings.mBuildingClass = mBPBuildingClass;
+	city_grid_settings.mBarrierClass = mBPBarrierClass;
+	city_grid_settings.mCityClass = mBPCityClass;
+	city_grid_settings.mDeliveryTriggerClass = mBPDeliveryTriggerClass;
+	city_grid_settings.mLayout = GetCityLayout();
+	city_grid_settings.mChunkSize = mChunkSize;
+	city_grid_settings.mSeed = static_cast<int32>(mRandomStream.GetUnsignedInt());
+	city_grid_settings.mStreamingRadius = mChunkStreamingRadius;
+	city_grid_settings.mDisableDeliveryTriggerCollision = mUseGridDeliveryDetection;
+	mCityGrid.Initialize(city_grid_settings);
+
+	const TArray<UActorComponent*> rotation_comps = mCharacter->GetComponentsByTag(USceneComponent::StaticClass(), "RotationActor");
+	mRotationComp = (rotation_comps.Num() > 0 ? Cast<USceneComponent>(rotation_comps[0]) : nullptr);
+	ensure(mRotationComp != nullptr);
+
+	TArray<UCapsuleComponent*> capsules;
+	mCharacter->GetComponents(capsules, true);
+	ensure(capsules.Num() >= 1);
+	mCharacterCapsule = capsules[0];
+
+	mCharacterMovement = mCharacter->GetCharacterMovement();
+	mBikeMovement = mCharacterMovement;
+	mUseKinematicBikeMovement |= FParse::Param(FCommandLine::Get(), TEXT("RemembikeKinematicBike"));
+	mMeasureInputLatency |= FParse::Param(FCommandLine::Get(), TEXT("RemembikeInputLatency"));
+	if (mUseKinematicBikeMovement)
+	{
+		UGameJam2021BikeMovementComponent* kinematic_bike_movement = AddKinematicBikeMovement(mCharacter);
+		kinematic_bike_movement->mOnBarrierHit.AddDynamic(this, &AGameJam2021PlayerController::OnStunned);
+		mBikeMovement = kinematic_bike_movement;
+	}
+	mInvCharacterMaxSpeed = 1.0f / FMath::Max(mBikeMovement->GetMaxSpeed(), KINDA_SMALL_NUMBER);
+
+	// Ticked by SimulateStep instead, so the bike moves in the same fixed steps as the rest of the gameplay. That skips
+	// the tick prerequisites and the post physics tick of the character movement, which only matter when standing on
+	// simulated physics bodies, and the city has none.
+	mBikeMovement->SetComponentTickEnabled(false);
+	for (USceneComponent* visual_component : mCharacter->GetRootComponent()->GetAttachChildren())
+	{
+		if (!visual_component || visual_component->IsUsingAbsoluteLocation())
+			continue;
+
+		mBikeVisualComponents.Add(visual_component);
+		mBikeVisualTransforms.Add(visual_component->GetRelativeTransform());
+	}
+
+	mDirectionArrowsOpacityLUT.Bake(mDirectionArrowsOpacityCurve, mCurveLUTNumSamples);
+
+	mRouteGenerator.SetGridSize(mGridSize);
+	mRouteGenerator.SetSeed(mRandomStream.GetUnsignedInt());
+	mRouteGenerator.SetTrace(&mRouteTrace);
+	mDeliveryQueue.Initialize(mGridSize, mNumQueuedDeliveries, mRandomStream.GetUnsignedInt());
+	mStreetPathfinding.Initialize(mGridSize, mMaxCachedFlowFields, mMinFlowFieldRequests);
+	mDeliveryContent.Initialize(mDeliveryVariants, mDeliveryParticles, mNumQueuedDeliveries, mRandomStream.GetUnsignedInt());
+
+	FParse::Value(FCommandLine::Get(), TEXT("RemembikeTimeDilation="), mTimeDilation);
+	mTimeDilation = FMath::Max(mTimeDilation, 1.0f);
+	if (mTimeDilation > 1.0f && !mInputRecording.IsReplaying())
+	{
+		// Every frame is one step of game time times the dilation, and frames run as fast as they can
+		FApp::SetUseFixedTimeStep(true);
+		FApp::SetFixedDeltaTime(1.0 / mSimulationStepRate);
+		UGameplayStatics::SetGlobalTimeDilation(this, mTimeDilation);
+		UE_LOG(LogRemembike, Display, TEXT("Running %.1f times faster than real time"), UGameplayStatics::GetGlobalTimeDilation(this));
+	}
+
+	mUseAutopilot |= FParse::Param(FCommandLine::Get(), TEXT("RemembikeAutopilot"));
+	FParse::Value(FCommandLine::Get(), TEXT("RemembikeSoakDeliveries="), mSoakDeliveries);
+	if (mUseAutopilot)
+	{
+		FGameJam2021Autopilot::FSettings autopilot_settings;
+		autopilot_settings.mWaypointRadius = mBuildingSize * 0.2f;
+		mAutopilot.Initialize(autopilot_settings);
+	}
+
+	mCharacterStartTransform = mCharacter->GetActorTransform();
+	mStartControlRotation = ControlRotation;
+
+	// Only the chunks around the player are queued here. UpdateCityBuild spawns them over the next frames, with input
+	// disabled, and starts the session once they all are.
+	UpdateCityStreaming();
+	mNumCityBuildChunks = mCityGrid.GetNumPendingChunks();
+	mNumCityBuildFrames = 0;
+	mLongestCityBuildFrameSeconds = 0.0;
+	mIsBuildingCity = true;
+	DisableInput(this);
+}
+
+void AGameJam2021PlayerController::UpdateCityBuild()
+{
+	const double frame_start_time = FPlatformTime::Seconds();
+	const int num_pending_chunks = mCityGrid.ProcessPendingChunks(mChunkSpawnBudgetMs * 0.001);
+	mLongestCityBuildFrameSeconds = FMath::Max(mLongestCityBuildFrameSeconds, FPlatformTime::Seconds() - frame_start_time);
+	++mNumCityBuildFrames;
+
+	OnCityBuildProgress(mNumCityBuildChunks > 0 ? 1.0f - static_cast<float>(num_pending_chunks) / mNumCityBuildChunks : 1.0f);
+	if (num_pending_chunks > 0)
+		return;
+
+	mIsBuildingCity = false;
+	SpawnCrowd();
+	StartSession();
+
+	// From the first tick to the first playable frame, for comparing startup cost in headless runs
+	UE_LOG(LogRemembike, Display, TEXT("City built in %.3f ms over %d frames: %d chunks, at most %.3f ms of building per frame"),
+		FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - mCityBuildStartCycles), mNumCityBuildFrames, mNumCityBuildChunks,
+		mLongestCityBuildFrameSeconds * 1000.0);
+	ReportCityStats();
+	DumpRenderStats();
+
+	EnableInput(this);
+	OnCityBuilt();
+}
+
+void AGameJam2021PlayerController::SpawnCrowd()
+{
+	FParse::Value(FCommandLine::Get(), TEXT("RemembikePedestrians="), mNumPedestrians);
+	if (!mBPCrowdClass || mNumPedestrians <= 0)
+		return;
+
+	mCrowd = GetWorld()->SpawnActor<AGameJam2021Crowd>(mBPCrowdClass, FTransform::Identity);
+	if (ensure(mCrowd != nullptr))
+		mCrowd->Initialize(GetCityLayout(), mNumPedestrians, static_cast<int32>(mRandomStream.GetUnsignedInt()));
+}
+
+UGameJam2021BikeMovementComponent* AGameJam2021PlayerController::AddKinematicBikeMovement(ACharacter* inCharacter) const
+{
+	// Same limits as the character movement it replaces, which stays on the character but no longer ticks
+	UCharacterMovementComponent* character_movement = inCharacter->GetCharacterMovement();
+	UGameJam2021BikeMovementComponent* bike_movement = NewObject<UGameJam2021BikeMovementComponent>(inCharacter);
+	bike_movement->mMaxSpeed = character_movement->GetMaxSpeed();
+	bike_movement->mAcceleration = character_movement->GetMaxAcceleration();
+	bike_movement->mBraking = character_movement->GetMaxBrakingDeceleration();
+	bike_movement->mBikeRadius = inCharacter->GetCapsuleComponent()->GetScaledCapsuleRadius();
+	bike_movement->SetCityLayout(GetCityLayout());
+	bike_movement->SetUpdatedComponent(inCharacter->GetRootComponent());
+	bike_movement->RegisterComponent();
+	character_movement->SetComponentTickEnabled(false);
+	return bike_movement;
+}
+
+void AGameJam2021PlayerController::StartSession()
+{
+	mNextDeliveryGridPosition = FIntPoint(mGridSize / 2, mGridSize / 2);
+	mNextDeliveryBuildingSide = EDirection::RIGHT; // Initial;
+	UpdateCityStreaming();
+	mSimulation.mBikeTransform = mCharacter->GetActorTransform();
+	GenerateNextDelivery(EDirection::FORWARD, true);
+}
+
+void AGameJam2021PlayerController::RestartSession()
+{
+	if (mFirstTick || mIsBuildingCity)
+		return;
+
+	mRestartStartCycles = FPlatformTime::Cycles64();
+
+	ApplyInputBits(0);
+	mInputTimeline.Reset();
+	mInputLatency.mIsPending = false;
+	mCharacter->SetActorTransform(mCharacterStartTransform, false, nullptr, ETeleportType::ResetPhysics);
+	mBikeMovement->StopMovementImmediately();
+	ControlRotation = mStartControlRotation;
+
+	if (mNextDeliveryTrigger)
+		mNextDeliveryTrigger->SetActorHiddenInGame(true);
+	mNextDeliveryTrigger = nullptr;
+
+	// Same state as a freshly spawned controller, the city actors stay where they are
+	mSimulation = FSimulationState();
+	mSimulationTimeAccumulator = 0.0f;
+	mPreviousTotalRemainingTime = 25.0f;
+	mIsGameOver = false;
+	mIsHudStatePushed = false;
+	mStreamingCenterCell = FIntPoint(INDEX_NONE, INDEX_NONE);
+	mCurrentDeliveryZone = INDEX_NONE;
+	SetScore(mSimulation.mScore);
+
+	// The soak numbers of the previous session are reported, the new session counts from zero
+	if (mUseAutopilot)
+	{
+		mAutopilot.Report();
+		mAutopilot.Initialize(FGameJam2021Autopilot::FSettings(mAutopilot.GetSettings()));
+	}
+
+	// Restarts are not part of the recorded input, so a recording or replay ends at them
+	if (mInputRecording.IsRecording())
+	{
+		UE_LOG(LogRemembike, Display, TEXT("Input recording ended by a session restart after %d frames"), mInputRecording.GetNumFrames());
+		mInputRecording.EndRecording();
+	}
+	else if (mInputRecording.IsReplaying())
+	{
+		UE_LOG(LogRemembike, Display, TEXT("Input replay stopped by a session restart"));
+		FApp::SetUseFixedTimeStep(false);
+		mInputRecording = FGameJam2021InputRecording();
+	}
+
+	mDeliveryContent.Initialize(mDeliveryVariants, mDeliveryParticles, mNumQueuedDeliveries, mRandomStream.GetUnsignedInt());
+
+	StartSession();
+}
+
+void AGameJam2021PlayerController::BeginInputRecordingOrReplay()
+{
+	uint32 seed = (mRandomSeed != 0 ? static_cast<uint32>(mRandomSeed) : FPlatformTime::Cycles());
+	FParse::Value(FCommandLine::Get(), TEXT("RemembikeSeed="), seed);
+
+	FString file_path;
+	if (FParse::Value(FCommandLine::Get(), TEXT("RemembikeReplay="), file_path))
+	{
+		// The engine steps every frame with the delta time it was recorded with, see UpdateInputRecordingOrReplay
+		if (mInputRecording.BeginReplay(file_path, seed))
+			FApp::SetUseFixedTimeStep(true);
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("RemembikeRecord="), file_path))
+	{
+		mInputRecording.BeginRecording(file_path, seed);
+	}
+
+	UE_LOG(LogRemembike, Display, TEXT("Session seed %u"), seed);
+	mRandomStream.Initialize(static_cast<int32>(seed));
+}
+
+void AGameJam2021PlayerController::UpdateInputRecordingOrReplay(float& ioDeltaTime)
+{
+	if (mInputRecording.IsRecording())
+	{
+		mInputRecording.RecordFrame(GetInputBits() | GetTapBits(), ioDeltaTime);
+		return;
+	}
+
+	if (!mInputRecording.IsReplaying())
+		return;
+
+	uint8 input_bits = 0;
+	if (mInputRecording.ReplayFrame(input_bits, ioDeltaTime))
+	{
+		ApplyInputBits(input_bits);
+		if (mInputRecording.HasNextReplayFrame())
+		{
+			FApp::SetFixedDeltaTime(mInputRecording.GetNextReplayDeltaTime());
+			return;
+		}
+	}
+
+	UE_LOG(LogRemembike, Display, TEXT("Input replay finished after %d frames"), mInputRecording.GetNumFrames());
+	FApp::SetUseFixedTimeStep(false);
+	mInputRecording = FGameJam2021InputRecording();
+	if (FApp::IsUnattended())
+		FPlatformMisc::RequestExit(false);
+}
+
+uint8 AGameJam2021PlayerController::GetInputBits() const
+{
+	// The bits of FGameJam2021InputRecording are in the order of the buttons
+	uint8 input_bits = 0;
+	for (int button_i = 0; button_i < FGameJam2021InputTimeline::NumButtons; ++button_i)
+		input_bits |= (mInputTimeline.IsHeld(static_cast<FGameJam2021InputTimeline::EButton>(button_i)) ? 1 << button_i : 0);
+	return input_bits;
+}
+
+uint8 AGameJam2021PlayerController::GetTapBits() const
+{
+	uint8 tap_bits = 0;
+	for (int button_i = 0; button_i < FGameJam2021InputTimeline::NumButtons; ++button_i)
+		tap_bits |= (mInputTimeline.WasTapped(static_cast<FGameJam2021InputTimeline::EButton>(button_i)) ? 1 << button_i : 0);
+	return static_cast<uint8>(tap_bits << FGameJam2021InputRecording::TapBitsShift);
+}
+
+void AGameJam2021PlayerController::ApplyInputBits(const uint8 inInputBits)
+{
+	// Through the same calls the input bindings make, and only on changes, like pressing and releasing keys. Taps are
+	// pressed and released at once, the timeline makes them last the minimum tap time.
+	TGuardValue<bool> applying_input_bits(mIsApplyingInputBits, true);
+	const uint8 held_bits = GetInputBits();
+	for (int button_i = 0; button_i < FGameJam2021InputTimeline::NumButtons; ++button_i)
+	{
+		const FGameJam2021InputTimeline::EButton button = static_cast<FGameJam2021InputTimeline::EButton>(button_i);
+		const bool is_held = (inInputBits & (1 << button_i)) != 0;
+		const bool is_tapped = (inInputBits & (1 << (button_i + FGameJam2021InputRecording::TapBitsShift))) != 0;
+		if (is_tapped && !(held_bits & (1 << button_i)))
+		{
+			PressButton(button, EKeys::Invalid);
+			ReleaseButton(button, EKeys::Invalid);
+		}
+
+		if (is_held && !mInputTimeline.IsHeld(button))
+			PressButton(button, EKeys::Invalid);
+		else if (!is_held && mInputTimeline.IsHeld(button))
+			ReleaseButton(button, EKeys::Invalid);
+	}
+}
+
+void AGameJam2021PlayerController::PressButton(const FGameJam2021InputTimeline::EButton inButton, const FKey& inKey)
+{
+	if (mInputTimeline.IsHeld(inButton))
+		return;
+
+	const double event_time = GetInputEventTime(inKey, true);
+	mInputTimeline.Press(inButton, event_time);
+
+	// One press measured at a time, the later ones would only see the motion of the first
+	if (mMeasureInputLatency && !mInputLatency.mIsPending && mCharacter)
+	{
+		mInputLatency.mIsPending = true;
+		mInputLatency.mPressTime = event_time;
+		mInputLatency.mPressFrame = GFrameCounter;
+		mInputLatency.mLocation = mCharacter->GetActorLocation();
+		mInputLatency.mYaw = ControlRotation.Yaw;
+	}
+}
+
+void AGameJam2021PlayerController::ReleaseButton(const FGameJam2021InputTimeline::EButton inButton, const FKey& inKey)
+{
+	mInputTimeline.Release(inButton, GetInputEventTime(inKey, false));
+}
+
+double AGameJam2021PlayerController::GetInputEventTime(const FKey& inKey, const bool inIsPress) const
+{
+	// Recordings only have the buttons of every frame, so while recording or replaying, and for the autopilot, every
+	// event happens at the start of the frame
+	if (mIsApplyingInputBits || mInputRecording.IsRecording() || mInputRecording.IsReplaying())
+		return mInputTimeline.GetFrameStartTime();
+
+	const TPair<double, double>* key_event_times = mKeyEventTimes.Find(inKey);
+	if (!key_event_times)
+		return FPlatformTime::Seconds();
+	return (inIsPress ? key_event_times->Key : key_event_times->Value);
+}
+
+void AGameJam2021PlayerController::UpdateInputLatency()
+{
+	if (!mInputLatency.mIsPending)
+		return;
+
+	const bool is_moved = FVector::DistSquared2D(mCharacter->GetActorLocation(), mInputLatency.mLocation) > KINDA_SMALL_NUMBER;
+	const bool is_turned = !FMath::IsNearlyEqual(ControlRotation.Yaw, mInputLatency.mYaw);
+	if (!is_moved && !is_turned)
+		return;
+
+	const uint64 latency_frames = GFrameCounter - mInputLatency.mPressFrame;
+	const double latency_ms = (FPlatformTime::Seconds() - mInputLatency.mPressTime) * 1000.0;
+	mInputLatency.mIsPending = false;
+	++mInputLatency.mNumSamples;
+	mInputLatency.mTotalFrames += latency_frames;
+	mInputLatency.mTotalMs += latency_ms;
+	mInputLatency.mMaxMs = FMath::Max(mInputLatency.mMaxMs, latency_ms);
+	UE_LOG(LogRemembike, Display, TEXT("Input latency: %llu frames, %.2f ms until the bike %s"), latency_frames, latency_ms, is_turned ? TEXT("turned") : TEXT("moved"));
+}
+
+void AGameJam2021PlayerController::UpdateAutopilot(const float inDeltaTime)
+{
+	mAutopilot.RecordFrame(inDeltaTime);
+
+	bool is_stuck = false;
+	const uint8 input_bits = mAutopilot.Update(mCharacter->GetActorLocation(), ControlRotation.Yaw, inDeltaTime, is_stuck);
+	if (is_stuck)
+	{
+		// Put the bike on the waypoint it could not reach, so a long run carries on and the log tells where it got stuck
+		const FVector* waypoint = mAutopilot.GetCurrentWaypoint();
+		if (waypoint)
+			mCharacter->SetActorLocation(FVector(waypoint->X, waypoint->Y, mCharacter->GetActorLocation().Z), false, nullptr, ETeleportType::TeleportPhysics);
+	}
+	ApplyInputBits(input_bits);
+}
+
+void AGameJam2021PlayerController::SetAutopilotRoute(const FRouteState& inStartState, const FDeliveryRoute& inRoute)
+{
+	// A waypoint at the building side next to the street of every state the route goes through
+	const RouteCore::FCityLayout city_layout = GetCityLayout();
+	TArray<FVector> waypoints;
+	waypoints.Reserve(inRoute.mNumDirections);
+
+	FRouteState state = inStartState;
+	for (int direction_i = 0; direction_i < inRoute.mNumDirections; ++direction_i)
+	{
+		FRouteState next_state;
+		if (!mRouteGenerator.TryMove(state, inRoute.mDirections[direction_i], next_state))
+			break;
+		state = next_state;
+
+		const RouteCore::FWorldPosition world_pos = city_layout.GetGridWorldPosition(state.mGridPosition, state.mBuildingSide);
+		waypoints.Add(FVector(world_pos.X, world_pos.Y, 0));
+	}
+	mAutopilot.SetWaypoints(waypoints);
+}
+
+void AGameJam2021PlayerController::UpdateCityStreaming()
+{
+	// Only the chunks around the player are spawned
+	const FIntPoint player_cell = mCityGrid.GetCellAtWorldPosition(mCharacter->GetActorLocation());
+	if (player_cell == mStreamingCenterCell)
+		return;
+
+	mStreamingCenterCell = player_cell;
+	mCityGrid.UpdateStreaming(mStreamingCenterCell);
+}
+
+void AGameJam2021PlayerController::UpdateGridDeliveryDetection()
+{
+	// Only the target building side is tested, the zones of the sides around it overlap with its own
+	const bool is_in_zone = mCityGrid.IsInDeliveryZone(mCharacter->GetActorLocation(), mDeliveryDetectionRadius, mNextDeliveryGridPosition, mNextDeliveryBuildingSide);
+	const int zone = (is_in_zone ? mCityGrid.GetDeliveryTriggerIndex(mNextDeliveryGridPosition, mNextDeliveryBuildingSide) : INDEX_NONE);
+	if (zone == mCurrentDeliveryZone)
+		return;
+
+	// Entering the zone is where the trigger would have sent an overlap event. A delivery kept on the same side is
+	// only made again once the player has left it.
+	mCurrentDeliveryZone = zone;
+	if (zone == INDEX_NONE)
+		return;
+
+	++mNumOverlapCallbacksAvoided;
+	INC_DWORD_STAT(STAT_RemembikeOverlapCallbacksAvoided);
+	CSV_CUSTOM_STAT(Remembike, OverlapCallbacksAvoided, 1, ECsvCustomStatOp::Accumulate);
+	OnDeliveryMade();
+}
+
+void AGameJam2021PlayerController::ReportCityStats() const
+{
+	int num_actors = 0;
+	int num_components = 0;
+	for (TActorIterator<AActor> actor_it(GetWorld()); actor_it; ++actor_it)
+	{
+		++num_actors;
+		num_components += actor_it->GetComponents().Num();
+	}
+
+	const RouteCore::FCityCells& cells = mCityGrid.GetCells();
+	UE_LOG(LogRemembike, Display, TEXT("City of %dx%d spawned as %s in %.3f ms: %d of %d chunks, %d city actors, %llu bytes of cell data. World now has %d actors and %d components"),
+		cells.GetGridSize(), cells.GetGridSize(), mCityGrid.IsInstanced() ? TEXT("instances") : TEXT("actors"), mCityGrid.GetSpawnSeconds() * 1000.0,
+		mCityGrid.GetNumMaterializedChunks(), cells.GetNumChunks(), mCityGrid.GetNumSpawnedActors(), static_cast<uint64>(cells.GetAllocatedBytes()),
+		num_actors, num_components);
+}
+
+void AGameJam2021PlayerController::EndPlay(const EEndPlayReason::Type inEndPlayReason)
+{
+	mDeliveryQueue.Shutdown();
+	mDeliveryContent.Shutdown();
+	mInputRecording.EndRecording();
+
+	Super::EndPlay(inEndPlayReason);
+}
+
+void AGameJam2021PlayerController::PlayerTick(float inDeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RemembikePlayerTick);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AGameJam2021PlayerController::PlayerTick);
+	CSV_SCOPED_TIMING_STAT(Remembike, PlayerTick);
+
+	Super::PlayerTick(inDeltaTime);
+
+	if (mFirstTick)
+	{
+		mFirstTick = false;
+		InitializeOnFirstTick();
+	}
+
+	if (mIsBuildingCity)
+	{
+		UpdateCityBuild();
+		return;
+	}
+
+	if (mRestartStartCycles != 0)
+	{
+		// From the restart request to the first frame that plays the new session
+		UE_LOG(LogRemembike, Display, TEXT("Session restarted in %.3f ms"), FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - mRestartStartCycles));
+		mRestartStartCycles = 0;
+	}
+
+	UpdateInputRecordingOrReplay(inDeltaTime);
+	if (mUseAutopilot)
+		UpdateAutopilot(inDeltaTime);
+	UpdateInputLatency();
+
+	UpdateCityStreaming();
+	mCityGrid.ProcessPendingChunks(mChunkSpawnBudgetMs * 0.001);
+	if (mUseGridDeliveryDetection)
+		UpdateGridDeliveryDetection();
+
+	// Gameplay advances in fixed steps of the (world dilated) frame time, what is shown is interpolated between the last two
+	const float step_seconds = 1.0f / mSimulationStepRate;
+	const int max_steps = FMath::Max(mMaxSimulationStepsPerFrame, FMath::CeilToInt(mTimeDilation) + 1);
+	mInputTimeline.EndFrame(FPlatformTime::Seconds(), inDeltaTime, step_seconds);
+	mSimulationTimeAccumulator += inDeltaTime;
+	int num_steps = 0;
+	while (mSimulationTimeAccumulator >= step_seconds && num_steps < max_steps)
+	{
+		mPreviousSimulation = mSimulation;
+		SimulateStep(step_seconds);
+		mSimulationTimeAccumulator -= step_seconds;
+		++num_steps;
+	}
+	mSimulationTimeAccumulator = FMath::Min(mSimulationTimeAccumulator, step_seconds);
+	mInputTimeline.ClampPending(step_seconds * max_steps);
+	UpdateInputLatency();
+	const float step_alpha = mSimulationTimeAccumulator / step_seconds;
+	UpdateBikeInterpolation(step_alpha);
+
+	const float remaining_time = FMath::Lerp(mPreviousSimulation.mRemainingTime, mSimulation.mRemainingTime, step_alpha);
+	mHudState.mRemainingSeconds = FMath::Max(FMath::CeilToInt(remaining_time), 0);
+
+	if (mDirectionArrowsOpacityLUT.IsBaked())
+	{
+		const float time_since_show_arrows = FMath::Lerp(mPreviousSimulation.mTimeSinceShowArrows, mSimulation.mTimeSinceShowArrows, step_alpha);
+		const float norm_time = FMath::Min(time_since_show_arrows / mShowArrowsTime, 1.0f);
+		const float opacity = mDirectionArrowsOpacityLUT.Eval(norm_time);
+		mHudState.mArrowsOpacity = FGameJam2021HudState::Quantize(opacity, mHudOpacitySteps);
+	}
+
+	// GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, "DoGoAnimation");
+
+	const float animation_rate = mBikeMovement->Velocity.Size() * mInvCharacterMaxSpeed;
+	mHudState.mAnimationRate = FGameJam2021HudState::Quantize(animation_rate, mHudAnimationRateSteps);
+	FlushHudState();
+	INC_DWORD_STAT_BY(STAT_RemembikeHudEvents, mNumHudBlueprintCallsLastFrame);
+	CSV_CUSTOM_STAT(Remembike, HudEvents, mNumHudBlueprintCallsLastFrame, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Remembike, CityActors, mCityGrid.GetNumSpawnedActors(), ECsvCustomStatOp::Set);
+
+	// GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, mCharacter->GetActorRotation().ToString() );
+}
+
+void AGameJam2021PlayerController::SimulateStep(const float inStepSeconds)
+{
+	mSimulation.mRemainingTime -= inStepSeconds;
+	if (mSimulation.mRemainingTime < 0.0f && mUseAutopilot)
+	{
+		mAutopilot.RecordTimeout();
+		mSimulation.mRemainingTime = mPreviousTotalRemainingTime;
+	}
+	if (mSimulation.mRemainingTime < 0.0f && !mIsGameOver)
+	{
+		mIsGameOver = true;
+		GoToLoseScreen();
+	}
+
+	if (mSimulation.mIsStunned)
+	{
+		mSimulation.mTimeStunned += inStepSeconds;
+		if (mSimulation.mTimeStunned >= mStunTime)
+		{
+			mSimulation.mIsStunned = false;
+			mSimulation.mTimeStunned = 0.0f;
+		}
+	}
+
+	if (mSimulation.mTimeSinceShowArrows < mShowArrowsTime)
+		mSimulation.mTimeSinceShowArrows += inStepSeconds;
+
+	// Consumed while stunned too, so the time a button was held during the stun is not applied after it
+	const float throttle = mInputTimeline.ConsumeThrottle(inStepSeconds);
+	const float steering = mInputTimeline.ConsumeSteering(inStepSeconds);
+	if (!mSimulation.mIsStunned)
+	{
+		if (throttle != 0.0f)
+			mCharacter->AddMovementInput(mCharacter->GetActorForwardVector(), mForwardSpeed * inStepSeconds * throttle);
+		if (steering != 0.0f)
+		{
+			// Applied right away rather than once per frame, the next step moves along the new heading
+			ControlRotation = FRotator(0, ControlRotation.Yaw + mTurnSpeed * inStepSeconds * steering, 0);
+			mCharacter->FaceRotation(ControlRotation, inStepSeconds);
+		}
+	}
+
+	mBikeMovement->TickComponent(inStepSeconds, LEVELTICK_All, &mBikeMovement->PrimaryComponentTick);
+	mSimulation.mBikeTransform = mCharacter->GetActorTransform();
+}
+
+void AGameJam2021PlayerController::UpdateBikeInterpolation(const float inStepAlpha)
+{
+	// The bike itself stays where the last step left it for collisions and overlaps, only what is attached to it,
+	// the sprite and the camera, is shown between the last two steps. Teleports outside the steps are not interpolated.
+	const FTransform& root_transform = mCharacter->GetRootComponent()->GetComponentTransform();
+	const FTransform& bike_transform = mSimulation.mBikeTransform;
+	FTransform local_offset = FTransform::Identity;
+	if (root_transform.GetLocation().Equals(bike_transform.GetLocation()) && root_transform.GetRotation().Equals(bike_transform.GetRotation()))
+	{
+		FTransform shown_transform;
+		shown_transform.Blend(mPreviousSimulation.mBikeTransform, bike_transform, inStepAlpha);
+		shown_transform.SetScale3D(root_transform.GetScale3D());
+		local_offset = shown_transform.GetRelativeTransform(root_transform);
+	}
+
+	for (int component_i = 0; component_i < mBikeVisualComponents.Num(); ++component_i)
+	{
+		if (IsValid(mBikeVisualComponents[component_i]))
+			mBikeVisualComponents[component_i]->SetRelativeTransform(mBikeVisualTransforms[component_i] * local_offset);
+	}
+}
+
+void AGameJam2021PlayerController::FlushHudState()
+{
+	const EGameJam2021HudField changed_fields = (mIsHudStatePushed ? mHudState.GetChangedFields(mPushedHudState) :
+		EGameJam2021HudField::RemainingTime | EGameJam2021HudField::AnimationRate | EGameJam2021HudField::ArrowsOpacity);
+
+	++mNumHudFrames;
+	mNumHudBlueprintCallsLastFrame = 0;
+	mNumHudFieldUpdatesLastFrame = 0;
+	if (changed_fields == EGameJam2021HudField::None)
+		return;
+
+	mPushedHudState = mHudState;
+	mIsHudStatePushed = true;
+	++mNumHudPushes;
+	++mNumHudBlueprintCallsLastFrame;
+	PushHudState(mHudState, static_cast<int32>(changed_fields));
+
+	mNumHudBlueprintCalls += mNumHudBlueprintCallsLastFrame;
+	mNumHudFieldUpdates += mNumHudFieldUpdatesLastFrame;
+}
+
+void AGameJam2021PlayerController::PushHudState_Implementation(const FGameJam2021HudState& inHudState, int32 inChangedFields)
+{
+	const EGameJam2021HudField changed_fields = static_cast<EGameJam2021HudField>(inChangedFields);
+	if (EnumHasAnyFlags(changed_fields, EGameJam2021HudField::RemainingTime))
+	{
+		SetRemainingTime(static_cast<float>(inHudState.mRemainingSeconds));
+		++mNumHudBlueprintCallsLastFrame;
+		++mNumHudFieldUpdatesLastFrame;
+	}
+	if (EnumHasAnyFlags(changed_fields, EGameJam2021HudField::AnimationRate))
+	{
+		// Goes to the bike animation, not to a widget
+		SetAnimationRate(inHudState.mAnimationRate);
+		++mNumHudBlueprintCallsLastFrame;
+	}
+	if (EnumHasAnyFlags(changed_fields, EGameJam2021HudField::ArrowsOpacity))
+	{
+		SetDirectionArrowsOpacity(inHudState.mArrowsOpacity);
+		++mNumHudBlueprintCallsLastFrame;
+		++mNumHudFieldUpdatesLastFrame;
+	}
+}
+
+void AGameJam2021PlayerController::OnDeliveryMade()
+{
+	UE_LOG(LogRemembike, Verbose, TEXT("OnDeliveryMade()"));
+
+	if (mUseAutopilot)
+	{
+		mAutopilot.RecordDelivery();
+		if (mSoakDeliveries > 0 && mAutopilot.GetNumDeliveries() >= mSoakDeliveries)
+		{
+			mAutopilot.Report();
+			mUseAutopilot = false;
+			ApplyInputBits(0);
+			if (FApp::IsUnattended())
+				FPlatformMisc::RequestExit(false);
+		}
+	}
+
+	ShowThankDelivery();
+
+	EDirection start_dir = EDirection::FORWARD;
+	if (mNextDeliveryBuildingSide == EDirection::FORWARD || mNextDeliveryBuildingSide == EDirection::BACK)
+		start_dir = mCharacter->GetActorRotation().Yaw < 0 ? EDirection::LEFT : EDirection::RIGHT;
+	else
+		start_dir = FMath::Abs(mCharacter->GetActorRotation().Yaw) < 90 ? EDirection::FORWARD : EDirection::BACK;
+
+	// Reset rotation
+	/*
+	float yaw = 0.0f;
+	switch (start_dir)
+	{
+	case EDirection::FORWARD: yaw = 0.0f; break;
+	case EDirection::BACK: yaw = 180.0f; break;
+	case EDirection::LEFT: yaw = -90.0f; break;
+	case EDirection::RIGHT: yaw = 90.0f; break;
+	}
+	ControlRotation = FRotator(0, yaw, 0);
+	*/
+
+	GenerateNextDelivery(start_dir);
+}
+
+void AGameJam2021PlayerController::OnStunned()
+{
+	mSimulation.mIsStunned = true;
+	mSimulation.mTimeStunned = 0.0f;
+}
+
+RouteCore::FCityLayout AGameJam2021PlayerController::GetCityLayout() const
+{
+	RouteCore::FCityLayout city_layout;
+	city_layout.mGridSize = mGridSize;
+	city_layout.mBuildingSize = mBuildingSize;
+	return city_layout;
+}
+
+FString AGameJam2021PlayerController::GetDirectionString(const EDirection& inDirection) const
+{
+	return FString(RouteCore::GetDirectionString(inDirection));
+}
+
+void AGameJam2021PlayerController::GenerateNextDelivery(const EDirection& inStartFaceDirection, const bool inIsFirstDelivery)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RemembikeGenerateNextDelivery);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AGameJam2021PlayerController::GenerateNextDelivery);
+	CSV_SCOPED_TIMING_STAT(Remembike, GenerateNextDelivery);
+
+	FRouteState start_state;
+	start_state.mFacingDirection = inStartFaceDirection;
+	start_state.mBuildingSide = mNextDeliveryBuildingSide;
+	start_state.mGridPosition = ToGridPosition(mNextDeliveryGridPosition);
+
+	// The route is usually ready in mDeliveryQueue, generated on a worker from where the previous one was predicted
+	// to end. Otherwise it is generated here and the queue restarts from it.
+	// The destination is picked among the buildings whose shortest route is num_directions streets long.
+	// If no other building can be reached we stay on the current delivery building instead of leaving no trigger set.
+	// Recordings and replays wait for the worker, a route generated here would come from a different random stream.
+	const int num_directions = FGameJam2021DeliveryQueue::GetRouteLength(mPreviousTotalRemainingTime);
+	const bool is_deterministic = (mInputRecording.IsRecording() || mInputRecording.IsReplaying());
+	FDeliveryRoute route;
+	if (inIsFirstDelivery || !mDeliveryQueue.Pop(start_state, num_directions, route, is_deterministic))
+	{
+		// Every step of this route is recorded into mRouteTrace, use the DumpRouteTrace console command to see it
+		const bool is_route_generated = mRouteGenerator.GenerateRoute(start_state, num_directions, route);
+		INC_DWORD_STAT(STAT_RemembikeSyncRoutes);
+		INC_DWORD_STAT_BY(STAT_RemembikeRouteStatesVisited, mRouteGenerator.GetDistanceField().GetNumVisitedStates());
+		INC_DWORD_STAT_BY(STAT_RemembikeRouteMovesRejected, mRouteGenerator.GetDistanceField().GetNumRejectedMoves());
+		CSV_CUSTOM_STAT(Remembike, SyncRoutes, 1, ECsvCustomStatOp::Accumulate);
+
+		if (!is_route_generated)
+		{
+			UE_LOG(LogRemembike, Warning, TEXT("Could not generate a route, keeping the current delivery building"));
+			mAutopilot.RecordFailedRoute();
+		}
+		else if (!inIsFirstDelivery)
+		{
+			UE_LOG(LogRemembike, Verbose, TEXT("Delivery queue missed, %d empty and %d mispredicted of %d deliveries"),
+				mDeliveryQueue.GetNumEmptyFallbacks(), mDeliveryQueue.GetNumMismatches(), mDeliveryQueue.GetNumPopped() + mDeliveryQueue.GetNumEmptyFallbacks() + mDeliveryQueue.GetNumMismatches());
+		}
+		mDeliveryQueue.Restart(FGameJam2021DeliveryQueue::PredictNextStartState(route), FGameJam2021DeliveryQueue::GetNextTimeAllowance(mPreviousTotalRemainingTime));
+	}
+
+	const FRouteState& end_state = route.mEndState;
+	const FIntPoint end_grid_position = ToIntPoint(end_state.mGridPosition);
+
+	// const FVector delivery_world_pos = GetGridWorldPosition(end_grid_position, end_state.mBuildingSide);
+	// DrawDebugLine(GetWorld(), delivery_world_pos, delivery_world_pos + FVector(0, 0, 999999), FColor::Red, true, 15.0f, 0, 100.0f);
+
+	const bool is_delivery_in_boundary = GetCityLayout().IsInBoundary(end_state.mGridPosition);
+	const bool change_street_side = false; // !is_delivery_in_boundary && (rand() % 2 == 0); NOT WORKING
+	mNextDeliveryBuildingSide = (change_street_side ? RouteCore::GetOppositeDirection(end_state.mBuildingSide) : end_state.mBuildingSide);
+	mNextDeliveryGridPosition = end_grid_position + (change_street_side ? ToIntPoint(RouteCore::GetDirectionVector(end_state.mBuildingSide)) : FIntPoint(0, 0));
+	verify(mNextDeliveryGridPosition.X >= 0 && mNextDeliveryGridPosition.Y >= 0 && mNextDeliveryGridPosition.X < mGridSize && mNextDeliveryGridPosition.Y < mGridSize);
+
+	mShowArrowsTime = (mPreviousTotalRemainingTime / 2);
+
+	mNextDeliveryTrigger = mCityGrid.PlaceDeliveryTrigger(mNextDeliveryGridPosition, mNextDeliveryBuildingSide);
+	AActor* retired_delivery_trigger = mCityGrid.GetRetiredDeliveryTrigger();
+	if (retired_delivery_trigger && retired_delivery_trigger != mNextDeliveryTrigger && !inIsFirstDelivery)
+		FadeOutDeliveryTrigger(retired_delivery_trigger);
+
+	TWeakObjectPtr<AGameJam2021PlayerController> weak_this(this);
+	mDeliveryContent.AdvanceDelivery([weak_this]()
+	{
+		if (AGameJam2021PlayerController* controller = weak_this.Get())
+			controller->SetDeliveryContent(controller->mDeliveryContent.GetGrannySprite(), controller->mDeliveryContent.GetThankYouSprite(), controller->mDeliveryContent.GetParticles());
+	});
+
+	TArray<int> directions_array_for_blueprint;
+	for (int direction_i = 0; direction_i < route.mNumDirections; ++direction_i)
+	{
+		directions_array_for_blueprint.Push(static_cast<int>(route.mDirections[direction_i]));
+	}
+
+	mSimulation.mTimeSinceShowArrows = 0.0f;
+	ShowDirectionArrows(directions_array_for_blueprint);
+	if (mUseAutopilot)
+		SetAutopilotRoute(start_state, route);
+
+	// The time allowance keeps shrinking with every delivery and is meant for a num_directions streets route,
+	// so the time of this delivery is scaled to the streets it really takes
+	const float time_allowance = FGameJam2021DeliveryQueue::GetNextTimeAllowance(mPreviousTotalRemainingTime);
+	mPreviousTotalRemainingTime = time_allowance;
+	mSimulation.mRemainingTime = FMath::Max(time_allowance * route.mNumDirections / num_directions, 12.0f); // Reset remaining time
+	if (!inIsFirstDelivery)
+	{
+		mSimulation.mScore += 100.0f;
+		SetScore(mSimulation.mScore);
+	}
+
+	// Nothing to interpolate from across a new delivery, except where the bike was, which it keeps riding from
+	const FTransform previous_bike_transform = mPreviousSimulation.mBikeTransform;
+	mPreviousSimulation = mSimulation;
+	if (!inIsFirstDelivery)
+		mPreviousSimulation.mBikeTransform = previous_bike_transform;
+}
+
+void AGameJam2021PlayerController::FadeOutDeliveryTrigger_Implementation(AActor* inTrigger)
+{
+	if (!inTrigger)
+		return;
+
+	if (mDeliveryTriggerFadeSeconds <= 0.0f)
+	{
+		inTrigger->SetActorHiddenInGame(true);
+		return;
+	}
+
+	// Left shown if it became the active trigger again before the timer fired
+	TWeakObjectPtr<AActor> weak_trigger(inTrigger);
+	FTimerHandle timer_handle;
+	GetWorldTimerManager().SetTimer(timer_handle, FTimerDelegate::CreateWeakLambda(this, [this, weak_trigger]()
+	{
+		if (weak_trigger.IsValid() && weak_trigger.Get() != mNextDeliveryTrigger)
+			weak_trigger->SetActorHiddenInGame(true);
+	}), mDeliveryTriggerFadeSeconds, false);
+}
+
+void AGameJam2021PlayerController::OnOverlap(AActor* inOverlappedActor)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RemembikeOnOverlap);
+	TRACE_CPUPROFILER_EVENT_SCOPE(AGameJam2021PlayerController::OnOverlap);
+	CSV_SCOPED_TIMING_STAT(Remembike, OnOverlap);
+
+	UE_LOG(LogRemembike, VeryVerbose, TEXT("OnOverlap with %s, next delivery trigger is %s"), *GetNameSafe(inOverlappedActor), *GetNameSafe(mNextDeliveryTrigger));
+	++mNumOverlapCallbacks;
+	INC_DWORD_STAT(STAT_RemembikeOverlapCallbacks);
+	CSV_CUSTOM_STAT(Remembike, OverlapCallbacks, 1, ECsvCustomStatOp::Accumulate);
+
+	const int* trigger_index = mCityGrid.FindDeliveryTriggerIndex(inOverlappedActor);
+	if (!trigger_index)
+		return;
+
+	if (*trigger_index == mCityGrid.GetDeliveryTriggerIndex(mNextDeliveryGridPosition, mNextDeliveryBuildingSide))
+	{
+		OnDeliveryMade();
+	}
+}
+
+bool AGameJam2021PlayerController::FindStreetPath(const FVector& inStart, const FVector& inStartForward, const FVector& inGoal, TArray<FVector>& outWaypoints)
+{
+	outWaypoints.Reset();
+	if (!mStreetPathfinding.IsInitialized())
+		return false;
+
+	const RouteCore::FCityLayout city_layout = GetCityLayout();
+	const FRouteState goal_state = FGameJam2021StreetPathfinding::GetStateAt(city_layout, inGoal, FVector::ForwardVector);
+
+	FGameJam2021PathRequest request;
+	request.mStartState = FGameJam2021StreetPathfinding::GetStateAt(city_layout, inStart, inStartForward);
+	request.mGoalCell = goal_state.mGridPosition;
+	request.mGoalSide = goal_state.mBuildingSide;
+	const FGameJam2021PathResult result = mStreetPathfinding.FindPath(request);
+	if (!result.mIsFound)
+		return false;
+
+	mStreetPathfinding.GetWaypoints(city_layout, request.mStartState, result.mPath, outWaypoints);
+	return true;
+}
+
+void AGameJam2021PlayerController::DumpRouteTrace()
+{
+#if REMEMBIKE_ROUTE_TRACE
+	UE_LOG(LogRemembike, Display, TEXT("Route trace: %d of %u events"), mRouteTrace.GetNum(), mRouteTrace.GetNumRecorded());
+	for (int event_i = 0; event_i < mRouteTrace.GetNum(); ++event_i)
+	{
+		const RouteCore::FRouteEvent& event = mRouteTrace.GetEvent(event_i);
+		UE_LOG(LogRemembike, Display, TEXT("  #%u %s turn %s -> grid (%d, %d), facing %s, building side %s"),
+			event.mSequence,
+			ANSI_TO_TCHAR(RouteCore::GetRouteEventTypeString(event.mType)),
+			ANSI_TO_TCHAR(RouteCore::GetDirectionString(event.mTurn)),
+			event.mX, event.mY,
+			ANSI_TO_TCHAR(RouteCore::GetDirectionString(event.mFacingDirection)),
+			ANSI_TO_TCHAR(RouteCore::GetDirectionString(event.mBuildingSide)));
+	}
+#else
+	UE_LOG(LogRemembike, Warning, TEXT("Route tracing is compiled out of this build"));
+#endif
+}
+
+void AGameJam2021PlayerController::DumpDeliveryStats()
+{
+	UE_LOG(LogRemembike, Display, TEXT("Delivery queue: %d popped, %d generated synchronously because it was empty, %d because it was mispredicted"),
+		mDeliveryQueue.GetNumPopped(), mDeliveryQueue.GetNumEmptyFallbacks(), mDeliveryQueue.GetNumMismatches());
+	UE_LOG(LogRemembike, Display, TEXT("Delivery detection: %s, %d overlap callbacks, %d overlap callbacks avoided"),
+		mUseGridDeliveryDetection ? TEXT("grid") : TEXT("overlaps"), mNumOverlapCallbacks, mNumOverlapCallbacksAvoided);
+}
+
+void AGameJam2021PlayerController::DumpHudStats()
+{
+	const double num_frames = FMath::Max<double>(mNumHudFrames, 1);
+	UE_LOG(LogRemembike, Display, TEXT("HUD: %lld pushes in %lld frames, %.3f Blueprint calls and %.3f widget updates per frame (last frame %d and %d)"),
+		mNumHudPushes, mNumHudFrames, mNumHudBlueprintCalls / num_frames, mNumHudFieldUpdates / num_frames,
+		mNumHudBlueprintCallsLastFrame, mNumHudFieldUpdatesLastFrame);
+}
+
+void AGameJam2021PlayerController::DumpDeliveryContent()
+{
+	UE_LOG(LogRemembike, Display, TEXT("Delivery content: %d of %d variants loaded, %.2f MB estimated, %d load requests, %d deliveries shown before their content was loaded. %.1f MB of physical memory used"),
+		mDeliveryContent.GetNumResidentVariants(), mDeliveryVariants.Num(), mDeliveryContent.GetResidentBytes() / (1024.0 * 1024.0),
+		mDeliveryContent.GetNumLoadRequests(), mDeliveryContent.GetNumLateLoads(), FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0));
+}
+
+void AGameJam2021PlayerController::DumpRenderStats()
+{
+	int num_primitive_components = 0;
+	int num_sprite_components = 0;
+	int num_instance_components = 0;
+	int num_sprite_instances = 0;
+	int num_sprite_batches = 0;
+	for (TActorIterator<AActor> actor_it(GetWorld()); actor_it; ++actor_it)
+	{
+		TArray<UPrimitiveComponent*> primitive_components;
+		actor_it->GetComponents(primitive_components);
+		num_primitive_components += primitive_components.Num();
+
+		// Every sprite and flipbook component is a draw call of its own
+		for (const UPrimitiveComponent* primitive_component : primitive_components)
+		{
+			if (const UGameJam2021SpriteInstancesComponent* instance_component = Cast<UGameJam2021SpriteInstancesComponent>(primitive_component))
+			{
+				++num_instance_components;
+				num_sprite_instances += instance_component->GetInstanceCount();
+				num_sprite_batches += instance_component->GetNumBatches();
+			}
+			else if (primitive_component->IsA<UPaperSpriteComponent>() || primitive_component->IsA<UPaperFlipbookComponent>())
+			{
+				++num_sprite_components;
+			}
+		}
+	}
+
+	UE_LOG(LogRemembike, Display, TEXT("%d primitive components. Sprites: %d sprite and flipbook components, %d instances in %d sprite instances components, %d sprite draw calls"),
+		num_primitive_components, num_sprite_components, num_sprite_instances, num_instance_components, num_sprite_components + num_sprite_batches);
+}
+
+void AGameJam2021PlayerController::DumpInputLatency()
+{
+	const FInputLatency& latency = mInputLatency;
+	if (latency.mNumSamples == 0)
+	{
+		UE_LOG(LogRemembike, Display, TEXT("No input latency measured, enable mMeasureInputLatency or run with -RemembikeInputLatency"));
+		return;
+	}
+
+	UE_LOG(LogRemembike, Display, TEXT("Input latency over %d presses: %.2f frames, %.2f ms on average, %.2f ms at most"),
+		latency.mNumSamples, static_cast<double>(latency.mTotalFrames) / latency.mNumSamples, latency.mTotalMs / latency.mNumSamples, latency.mMaxMs);
+}
+
+void AGameJam2021PlayerController::BenchmarkCurveLUTs(int32 inNumEvaluations)
+{
+	if (!mDirectionArrowsOpacityCurve)
+	{
+		UE_LOG(LogRemembike, Warning, TEXT("No direction arrows opacity curve to benchmark"));
+		return;
+	}
+
+	FGameJam2021FloatCurveLUT lut;
+	lut.Bake(mDirectionArrowsOpacityCurve, mCurveLUTNumSamples);
+
+	float min_time = 0.0f;
+	float max_time = 0.0f;
+	mDirectionArrowsOpacityCurve->GetTimeRange(min_time, max_time);
+
+	// Same times for both, and summing the results keeps the evaluations from being optimized away
+	const int num_evaluations = FMath::Max(inNumEvaluations, 1);
+	const float time_step = (max_time - min_time) / num_evaluations;
+	const FRichCurve& rich_curve = mDirectionArrowsOpacityCurve->FloatCurve;
+
+	float curve_sum = 0.0f;
+	const uint64 curve_start_cycles = FPlatformTime::Cycles64();
+	for (int evaluation_i = 0; evaluation_i < num_evaluations; ++evaluation_i)
+		curve_sum += rich_curve.Eval(min_time + evaluation_i * time_step);
+	const uint64 curve_cycles = FPlatformTime::Cycles64() - curve_start_cycles;
+
+	float lut_sum = 0.0f;
+	const uint64 lut_start_cycles = FPlatformTime::Cycles64();
+	for (int evaluation_i = 0; evaluation_i < num_evaluations; ++evaluation_i)
+		lut_sum += lut.Eval(min_time + evaluation_i * time_step);
+	const uint64 lut_cycles = FPlatformTime::Cycles64() - lut_start_cycles;
+
+	float max_error = 0.0f;
+	for (int evaluation_i = 0; evaluation_i < num_evaluations; ++evaluation_i)
+	{
+		const float time = min_time + evaluation_i * time_step;
+		max_error = FMath::Max(max_error, FMath::Abs(rich_curve.Eval(time) - lut.Eval(time)));
+	}
+
+	UE_LOG(LogRemembike, Display, TEXT("%s, %d samples: FRichCurve::Eval %.2f ns, LUT %.2f ns per evaluation, max error %f (checksums %f %f)"),
+		*GetNameSafe(mDirectionArrowsOpacityCurve), mCurveLUTNumSamples,
+		FPlatformTime::ToSeconds64(curve_cycles) * 1e9 / num_evaluations, FPlatformTime::ToSeconds64(lut_cycles) * 1e9 / num_evaluations,
+		max_error, curve_sum, lut_sum);
+}
+
+void AGameJam2021PlayerController::BenchmarkCrowd(int32 inNumSteps)
+{
+	if (!mCrowd)
+	{
+		UE_LOG(LogRemembike, Warning, TEXT("No crowd to benchmark, set mBPCrowdClass and mNumPedestrians"));
+		return;
+	}
+
+	mCrowd->RunBenchmark(inNumSteps);
+}
+
+void AGameJam2021PlayerController::BenchmarkBikeMovement(int32 inNumBikes, int32 inNumFrames)
+{
+	if (!mCharacter)
+		return;
+
+	const int num_bikes = FMath::Max(inNumBikes, 1);
+	const int num_frames = FMath::Max(inNumFrames, 1);
+	const float frame_seconds = 1.0f / 60.0f;
+	const RouteCore::FCityLayout city_layout = GetCityLayout();
+
+	// Bikes of the player class, without controller, starting at random building sides
+	FActorSpawnParameters spawn_parameters;
+	spawn_parameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	FRandomStream random_stream(num_bikes);
+	TArray<ACharacter*> bikes;
+	for (int bike_i = 0; bike_i < num_bikes; ++bike_i)
+	{
+		const RouteCore::FGridPosition cell(random_stream.RandHelper(mGridSize), random_stream.RandHelper(mGridSize));
+		const RouteCore::FWorldPosition position = city_layout.GetGridWorldPosition(cell, static_cast<EDirection>(random_stream.RandHelper(RouteCore::NumDirections)));
+		const FTransform transform(FRotator(0.0f, 90.0f * random_stream.RandHelper(4), 0.0f), FVector(position.X, position.Y, mCharacterStartTransform.GetLocation().Z));
+		ACharacter* bike = GetWorld()->SpawnActor<ACharacter>(mCharacter->GetClass(), transform, spawn_parameters);
+		if (!bike)
+			continue;
+
+		bike->GetCharacterMovement()->bRunPhysicsWithNoController = true;
+		bikes.Add(bike);
+	}
+
+	// Same input for both, and the movement components are ticked directly so nothing else of the frame is measured
+	double movement_seconds[2] = { 0.0, 0.0 };
+	for (int path_i = 0; path_i < 2; ++path_i)
+	{
+		TArray<UPawnMovementComponent*> movements;
+		for (ACharacter* bike : bikes)
+			movements.Add(path_i == 0 ? static_cast<UPawnMovementComponent*>(bike->GetCharacterMovement()) : AddKinematicBikeMovement(bike));
+
+		const double start_time = FPlatformTime::Seconds();
+		for (int frame_i = 0; frame_i < num_frames; ++frame_i)
+		{
+			for (int bike_i = 0; bike_i < bikes.Num(); ++bike_i)
+			{
+				bikes[bike_i]->AddMovementInput(bikes[bike_i]->GetActorForwardVector(), 1.0f);
+				movements[bike_i]->TickComponent(frame_seconds, LEVELTICK_All, &movements[bike_i]->PrimaryComponentTick);
+			}
+		}
+		movement_seconds[path_i] = FPlatformTime::Seconds() - start_time;
+	}
+
+	for (ACharacter* bike : bikes)
+		bike->Destroy();
+
+	const int num_spawned_bikes = FMath::Max(bikes.Num(), 1);
+	UE_LOG(LogRemembike, Display, TEXT("%d bikes over %d frames: character movement %.2f us, kinematic bike movement %.2f us per frame (%.3f and %.3f us per bike)"),
+		bikes.Num(), num_frames, movement_seconds[0] * 1e6 / num_frames, movement_seconds[1] * 1e6 / num_frames,
+		movement_seconds[0] * 1e6 / (num_frames * num_spawned_bikes), movement_seconds[1] * 1e6 / (num_frames * num_spawned_bikes));
+}
+
+void AGameJam2021PlayerController::BenchmarkPathfinding(int32 inNumQueries, int32 inNumGoals)
+{
+	const int num_queries = FMath::Max(inNumQueries, 1);
+	const int num_goals = FMath::Max(inNumGoals, 1);
+
+	// Random starts toward a few goals, like pedestrians heading to the same places
+	FRandomStream random_stream(num_queries);
+	auto get_random_state = [this, &random_stream]()
+	{
+		FRouteState state;
+		state.mGridPosition = RouteCore::FGridPosition(random_stream.RandHelper(mGridSize), random_stream.RandHelper(mGridSize));
+		state.mFacingDirection = static_cast<EDirection>(random_stream.RandHelper(RouteCore::NumDirections));
+		state.mBuildingSide = static_cast<EDirection>(random_stream.RandHelper(RouteCore::NumDirections));
+		return state;
+	};
+
+	TArray<FRouteState> goal_states;
+	for (int goal_i = 0; goal_i < num_goals; ++goal_i)
+		goal_states.Add(get_random_state());
+
+	TArray<FGameJam2021PathRequest> requests;
+	requests.SetNum(num_queries);
+	for (FGameJam2021PathRequest& request : requests)
+	{
+		const FRouteState& goal_state = goal_states[random_stream.RandHelper(num_goals)];
+		request.mStartState = get_random_state();
+		request.mGoalCell = goal_state.mGridPosition;
+		request.mGoalSide = goal_state.mBuildingSide;
+	}
+
+	// A service of its own, so the cached flow fields of the game do not make the batch look faster
+	FGameJam2021StreetPathfinding pathfinding;
+	const double initialize_start_time = FPlatformTime::Seconds();
+	pathfinding.Initialize(mGridSize, mMaxCachedFlowFields, mMinFlowFieldRequests);
+	const double initialize_seconds = FPlatformTime::Seconds() - initialize_start_time;
+
+	// One by one, with the flow fields turned off so every query runs A*
+	FGameJam2021StreetPathfinding serial_pathfinding;
+	serial_pathfinding.Initialize(mGridSize, 0, TNumericLimits<int32>::Max());
+	int num_found = 0;
+	const double serial_start_time = FPlatformTime::Seconds();
+	for (const FGameJam2021PathRequest& request : requests)
+		num_found += (serial_pathfinding.FindPath(request).mIsFound ? 1 : 0);
+	const double serial_seconds = FPlatformTime::Seconds() - serial_start_time;
+
+	int num_batch_found = 0;
+	int num_from_flow_fields = 0;
+	const double batch_start_time = FPlatformTime::Seconds();
+	const TArray<FGameJam2021PathResult> results = pathfinding.FindPathsAsync(requests).Get();
+	const double batch_seconds = FPlatformTime::Seconds() - batch_start_time;
+	for (const FGameJam2021PathResult& result : results)
+	{
+		num_batch_found += (result.mIsFound ? 1 : 0);
+		num_from_flow_fields += (result.mIsFromFlowField ? 1 : 0);
+	}
+
+	UE_LOG(LogRemembike, Display, TEXT("Street paths on a %dx%d grid, graph built in %.3f ms, %llu bytes with %d cached flow fields"),
+		mGridSize, mGridSize, initialize_seconds * 1000.0, static_cast<uint64>(pathfinding.GetAllocatedBytes()), pathfinding.GetNumCachedFlowFields());
+	UE_LOG(LogRemembike, Display, TEXT("%d queries toward %d goals: A* one by one %.3f ms (%.2f us per query, %d found), batch %.3f ms (%d found, %d from flow fields)"),
+		num_queries, num_goals, serial_seconds * 1000.0, serial_seconds * 1e6 / num_queries, num_found, batch_seconds * 1000.0, num_batch_found, num_from_flow_fields);
+}
+
+void AGameJam2021PlayerController::SetupInputComponent()
+{
+	// set up gameplay key bindings
+	Super::SetupInputComponent();
+
+	// A replayed session only takes the bike controls from the recording
+	FString replay_file_path;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("RemembikeReplay="), replay_file_path))
+	{
+		InputComponent->BindAction("GoForward", IE_Pressed, this, &AGameJam2021PlayerController::GoForwardPressed);
+		InputComponent->BindAction("GoBack", IE_Pressed, this, &AGameJam2021PlayerController::GoBackPressed);
+		InputComponent->BindAction("TurnLeft", IE_Pressed, this, &AGameJam2021PlayerController::TurnLeftPressed);
+		InputComponent->BindAction("TurnRight", IE_Pressed, this, &AGameJam2021PlayerController::TurnRightPressed);
+		InputComponent->BindAction("GoForward", IE_Released, this, &AGameJam2021PlayerController::GoForwardReleased);
+		InputComponent->BindAction("GoBack", IE_Released, this, &AGameJam2021PlayerController::GoBackReleased);
+		InputComponent->BindAction("TurnLeft", IE_Released, this, &AGameJam2021PlayerController::TurnLeftReleased);
+		InputComponent->BindAction("TurnRight", IE_Released, this, &AGameJam2021PlayerController::TurnRightReleased);
+		InputComponent->BindAxis("Steering", this, &AGameJam2021PlayerController::OnSteeringAxis);
+		InputComponent->BindAxis("Throttle", this, &AGameJam2021PlayerController::OnThrottleAxis);
+	}
+
+	FInputActionBinding& toggle = InputComponent->BindAction("Pause", IE_Pressed, this, &AGameJam2021PlayerController::OnPausePressed);
+	toggle.bExecuteWhenPaused = true;
+}
+
+bool AGameJam2021PlayerController::InputKey(FKey inKey, EInputEvent inEventType, float inAmountDepressed, bool inGamepad)
+{
+	if (inEventType == IE_Pressed)
+		mKeyEventTimes.FindOrAdd(inKey).Key = FPlatformTime::Seconds();
+	else if (inEventType == IE_Released)
+		mKeyEventTimes.FindOrAdd(inKey).Value = FPlatformTime::Seconds();
+
+	return Super::InputKey(inKey, inEventType, inAmountDepressed, inGamepad);
+}
+
+void AGameJam2021PlayerController::GoForwardPressed(FKey inKey)
+{
+	PressButton(FGameJam2021InputTimeline::GoForward, inKey);
+}
+void AGameJam2021PlayerController::GoBackPressed(FKey inKey)
+{
+	PressButton(FGameJam2021InputTimeline::GoBack, inKey);
+}
+void AGameJam2021PlayerController::TurnLeftPressed(FKey inKey)
+{
+	PressButton(FGameJam2021InputTimeline::TurnLeft, inKey);
+}
+void AGameJam2021PlayerController::TurnRightPressed(FKey inKey)
+{
+	PressButton(FGameJam2021InputTimeline::TurnRight, inKey);
+}
+
+void AGameJam2021PlayerController::GoForwardReleased(FKey inKey)
+{
+	ReleaseButton(FGameJam2021InputTimeline::GoForward, inKey);
+}
+void AGameJam2021PlayerController::GoBackReleased(FKey inKey)
+{
+	ReleaseButton(FGameJam2021InputTimeline::GoBack, inKey);
+}
+void AGameJam2021PlayerController::TurnLeftReleased(FKey inKey)
+{
+	ReleaseButton(FGameJam2021InputTimeline::TurnLeft, inKey);
+}
+void AGameJam2021PlayerController::TurnRightReleased(FKey inKey)
+{
+	ReleaseButton(FGameJam2021InputTimeline::TurnRight, inKey);
+}
+
+void AGameJam2021PlayerController::OnSteeringAxis(float inValue)
+{
+	// Recordings only have the buttons
+	mInputTimeline.SetSteering(mInputRecording.IsRecording() ? 0.0f : inValue);
+}
+void AGameJam2021PlayerController::OnThrottleAxis(float inValue)
+{
+	mInputTimeline.SetThrottle(mInputRecording.IsRecording() ? 0.0f : inValue);
+}
+
+void AGameJam2021PlayerController::OnPausePressed()
+{
+	OnPausePressedBP();
+}
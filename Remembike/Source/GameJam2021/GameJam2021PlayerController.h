@@ -1,151 +1,449 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#pragma once
-
-#include <array>
-#include "CoreMinimal.h"
-#include "GameFramework/PlayerController.h"
-#include "Curves/CurveVector.h"
-#include "Curves/CurveFloat.h"
-#include "GameFramework/Character.h"
-#include "Components/CapsuleComponent.h"
-#include "GameFramework/CharacterMovementComponent.h"
-#include "Components/SceneComponent.h"
-#include <vector>
-#include "GameJam2021PlayerController.generated.h"
-
-UCLASS()
-class AGameJam2021PlayerController : public APlayerController
-{
-	GENERATED_BODY()
-
-public:
-	AGameJam2021PlayerController();
-
-	UPROPERTY(EditAnywhere)
-	float mStunTime = 1.0f;
-
-	UPROPERTY(EditAnywhere)
-	float mForwardSpeed = 100.0f;
-
-	UPROPERTY(EditAnywhere)
-	float mTurnSpeed = 1.0f;
-
-	UPROPERTY(EditAnywhere)
-	float mBuildingSize = 100.0f;
-
-	UPROPERTY(EditAnywhere)
-	float mShowArrowsTime = 2.0f;
-
-	UPROPERTY(EditAnywhere)
-	UClass* mBPBuildingClass = nullptr;
-
-	UPROPERTY(EditAnywhere)
-	UClass* mBPBarrierClass = nullptr;
-
-	UPROPERTY(EditAnywhere)
-	UCurveFloat *mDirectionArrowsOpacityCurve = nullptr;
-
-	UFUNCTION(BlueprintCallable)
-	void OnDeliveryMade();
-
-	UFUNCTION(BlueprintCallable)
-	void OnStunned();
-
-	UFUNCTION(BlueprintCallable)
-	void OnOverlap(AActor* inOverlappedActor);
-
-	UFUNCTION(BlueprintImplementableEvent)
-	void ShowDirectionArrows(const TArray<int>& directions);
-	void ShowDirectionArrows_Implementation(const TArray<int>& directions) {}
-	UFUNCTION(BlueprintImplementableEvent)
-	void SetDirectionArrowsOpacity(const float inOpacity);
-	void SetDirectionArrowsOpacity_Implementation(const float inOpacity) {}
-
-	UFUNCTION(BlueprintImplementableEvent)
-	void ShowThankDelivery();
-	void ShowThankDelivery_Implementation() {}
-
-	UFUNCTION(BlueprintImplementableEvent)
-	void OnPausePressedBP();
-	void OnPausePressedBP_Implementation() {}
-
-	UFUNCTION(BlueprintImplementableEvent)
-	void SetAnimationRate(const float inAnimationRate);
-	void SetAnimationRate_Implementation(const float inAnimationRate) {}
-
-	UFUNCTION(BlueprintImplementableEvent)
-	void SetRemainingTime(const float inRemainingTime);
-	void SetRemainingTime_Implementation(const float inRemainingTime) {}
-
-	UFUNCTION(BlueprintImplementableEvent)
-	void SetScore(const float inScore);
-	void SetScore_Implementation(const float inScore) {}
-
-	UFUNCTION(BlueprintImplementableEvent)
-	void GoToLoseScreen();
-	void GoToLoseScreen_Implementation() {}
-
-	UPROPERTY(EditAnywhere)
-	AActor* mNextDeliveryTrigger = nullptr;
-
-	UFUNCTION(BlueprintCallable)
-	void OnPausePressed();
-
-protected:
-	enum class EDirection
-	{
-		BACK,
-		FORWARD,
-		LEFT,
-		RIGHT
-	};
-
-	void InitializeOnFirstTick();
-	virtual void PlayerTick(float inDeltaTime) override;
-	virtual void SetupInputComponent() override;
-
-	void GoForwardPressed();
-	void GoBackPressed();
-	void TurnLeftPressed();
-	void TurnRightPressed();
-	void GoForwardReleased();
-	void GoBackReleased();
-	void TurnLeftReleased();
-	void TurnRightReleased();
-
-	void GenerateNextDelivery(const EDirection & inStartFaceDirection, const bool inIsFirstDelivery = false);
-
-private:
-	EDirection GetOppositeDirection(const EDirection& inDirection) const;
-	FVector GetGridWorldPosition(const FVector2D& inGridPositionInt) const;
-	FVector GetGridWorldPosition(const FVector2D& inGridPositionInt, const EDirection &inBuildingSide) const;
-	FVector2D GetDirectionVector(const EDirection &inDirection) const;
-	FString GetDirectionString(const EDirection& inDirection) const;
-
-	static constexpr int BuildingArraySize = 6;
-	std::array<std::array<AActor*, BuildingArraySize>, BuildingArraySize> mBuildings;
-
-	FVector2D mNextDeliveryGridPosition = FVector2D(0, 0);
-	EDirection mNextDeliveryBuildingSide = EDirection::FORWARD;
-
-	bool mGoingForward = false;
-	bool mGoingBack = false;
-	bool mTurningLeft = false;
-	bool mTurningRight = false;
-	bool mFirstTick = true;
-
-	float mRemainingTime = 0.0f;
-	float mPreviousTotalRemainingTime = 25.0;
-	float mScore = 0.0f;
-	float mTimeStunned = 0.0f;
-	bool mIsStunned = true;
-
-	float mTimeSinceShowArrows = 0.0f;
-
-	ACharacter* mCharacter = nullptr;
-	UCapsuleComponent *mCharacterCapsule = nullptr;
-	USceneComponent* mRotationComp = nullptr;
-};
-
-
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "Curves/CurveVector.h"
+#include "Curves/CurveFloat.h"
+#include "GameFramework/Character.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Components/SceneComponent.h"
+#include "GameJam2021City.h"
+#include "GameJam2021CityGrid.h"
+#include "GameJam2021Crowd.h"
+#include "GameJam2021CurveLUT.h"
+#include "GameJam2021DeliveryContent.h"
+#include "GameJam2021DeliveryQueue.h"
+#include "GameJam2021HudState.h"
+#include "GameJam2021Autopilot.h"
+#include "GameJam2021BikeMovementComponent.h"
+#include "GameJam2021InputRecording.h"
+#include "GameJam2021InputTimeline.h"
+#include "GameJam2021StreetPathfinding.h"
+#include "RouteCore/RouteGenerator.h"
+#include "GameJam2021PlayerController.generated.h"
+
+UCLASS()
+class AGameJam2021PlayerController : public APlayerController
+{
+	GENERATED_BODY()
+
+public:
+	AGameJam2021PlayerController();
+
+	UPROPERTY(EditAnywhere)
+	float mStunTime = 1.0f;
+
+	UPROPERTY(EditAnywhere)
+	float mForwardSpeed = 100.0f;
+
+	UPROPERTY(EditAnywhere)
+	float mTurnSpeed = 1.0f;
+
+	UPROPERTY(EditAnywhere)
+	float mBuildingSize = 100.0f;
+
+	// Moves the bike with UGameJam2021BikeMovementComponent instead of the character movement, and stuns on its
+	// barrier hits. Can be enabled with -RemembikeKinematicBike.
+	UPROPERTY(EditAnywhere)
+	bool mUseKinematicBikeMovement = false;
+
+	// Seed of everything random in a session, 0 picks a new one every session. Can be overridden with -RemembikeSeed=<seed>.
+	// -RemembikeRecord=<file> records the seed and the input of the session, -RemembikeReplay=<file> plays it back.
+	UPROPERTY(EditAnywhere)
+	int32 mRandomSeed = 0;
+
+	// Rides the bike along the route of every delivery, for soak tests. Also enabled with -RemembikeAutopilot, which
+	// runs headless with -nullrhi -unattended. The time limit never ends the game, timeouts are counted instead.
+	UPROPERTY(EditAnywhere)
+	bool mUseAutopilot = false;
+
+	// With the autopilot, reports and quits after this many deliveries, 0 never quits. Can be overridden with -RemembikeSoakDeliveries=<count>
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+	int mSoakDeliveries = 0;
+
+	// Logs the time from every bike button press to the first tick that sees the bike move or turn, in frames and
+	// milliseconds. Can be enabled with -RemembikeInputLatency, DumpInputLatency prints the totals.
+	UPROPERTY(EditAnywhere)
+	bool mMeasureInputLatency = false;
+
+	// Gameplay steps per second. The timer, stun, arrow fade, bike controls and bike movement advance in steps of this size
+	// whatever the frame rate. The HUD, and the bike components and camera, are shown interpolated between the last two steps.
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1"))
+	float mSimulationStepRate = 60.0f;
+
+	// Longer frames are not caught up with, so a hitch does not make the next frames even longer
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1"))
+	int mMaxSimulationStepsPerFrame = 8;
+
+	// Above 1, runs the game this many times faster than real time: every frame is a fixed step of game time multiplied
+	// by the dilation, and frames do not wait for the wall clock. For headless runs. Can be overridden with -RemembikeTimeDilation=<dilation>
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1"))
+	float mTimeDilation = 1.0f;
+
+	// Number of buildings per city side, can be overridden with -RemembikeGridSize=<size>
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1", ClampMax = "256"))
+	int mGridSize = 6;
+
+	// Buildings per chunk side, the city is spawned and released one chunk at a time
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1"))
+	int mChunkSize = 8;
+
+	// Chunks around the player that are kept spawned
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+	int mChunkStreamingRadius = 2;
+
+	// Milliseconds per frame spent spawning queued chunks, both while the city is built and while riding
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+	float mChunkSpawnBudgetMs = 4.0f;
+
+	UPROPERTY(EditAnywhere)
+	float mShowArrowsTime = 2.0f;
+
+	// Detects deliveries by checking the character position against the target building side every tick,
+	// instead of with overlap events, which are then turned off for every delivery trigger
+	UPROPERTY(EditAnywhere)
+	bool mUseGridDeliveryDetection = false;
+
+	// Distance to the delivery trigger position at which a delivery is made, with grid delivery detection
+	UPROPERTY(EditAnywhere, meta = (EditCondition = "mUseGridDeliveryDetection"))
+	float mDeliveryDetectionRadius = 25.0f;
+
+	// Deliveries generated ahead of time on a worker thread
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1"))
+	int mNumQueuedDeliveries = 3;
+
+	UPROPERTY(EditAnywhere)
+	UClass* mBPBuildingClass = nullptr;
+
+	UPROPERTY(EditAnywhere)
+	UClass* mBPBarrierClass = nullptr;
+
+	// When set, buildings and barriers are rendered as instances of this city instead of spawning mBPBuildingClass
+	// and mBPBarrierClass actors
+	UPROPERTY(EditAnywhere)
+	TSubclassOf<AGameJam2021City> mBPCityClass = nullptr;
+
+	// Trigger moved to the building side of every delivery. When not set, the class of the delivery trigger child
+	// actors of mBPBuildingClass is used.
+	UPROPERTY(EditAnywhere)
+	UClass* mBPDeliveryTriggerClass = nullptr;
+
+	// Time the previous delivery trigger stays shown after a delivery, see FadeOutDeliveryTrigger
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+	float mDeliveryTriggerFadeSeconds = 0.5f;
+
+	// Pedestrians spawned once the city is built
+	UPROPERTY(EditAnywhere)
+	TSubclassOf<AGameJam2021Crowd> mBPCrowdClass = nullptr;
+
+	// Can be overridden with -RemembikePedestrians=<count>
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+	int mNumPedestrians = 100;
+
+	// Street paths toward a goal that this many requests of a batch share are read off a flow field instead of A*
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1"))
+	int mMinFlowFieldRequests = 8;
+
+	// Flow fields kept for the next path requests, the least recently used is dropped first
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0"))
+	int mMaxCachedFlowFields = 4;
+
+	// Granny and thank-you sprites of the deliveries, one picked at random per delivery. They are streamed in ahead of
+	// time, only the ones of the current delivery and of the next mNumQueuedDeliveries stay loaded.
+	UPROPERTY(EditAnywhere)
+	TArray<FGameJam2021DeliveryVariant> mDeliveryVariants;
+
+	UPROPERTY(EditAnywhere)
+	TSoftObjectPtr<UParticleSystem> mDeliveryParticles;
+
+	UPROPERTY(EditAnywhere)
+	UCurveFloat *mDirectionArrowsOpacityCurve = nullptr;
+
+	// Samples the curves above are baked into, the tick only evaluates the baked samples
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "2"))
+	int mCurveLUTNumSamples = 64;
+
+	// HUD values are only pushed to Blueprint when they change by at least one of these steps
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1"))
+	int mHudOpacitySteps = 16;
+
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1"))
+	int mHudAnimationRateSteps = 20;
+
+	UFUNCTION(BlueprintCallable)
+	void OnDeliveryMade();
+
+	UFUNCTION(BlueprintCallable)
+	void OnStunned();
+
+	UFUNCTION(BlueprintCallable)
+	void OnOverlap(AActor* inOverlappedActor);
+
+	// Path along the streets from a location, heading along inStartForward, to the building side closest to inGoal.
+	// The waypoints are the building sides the path goes by, for pedestrians and bots instead of navmesh queries.
+	UFUNCTION(BlueprintCallable)
+	bool FindStreetPath(const FVector& inStart, const FVector& inStartForward, const FVector& inGoal, TArray<FVector>& outWaypoints);
+
+	UFUNCTION(BlueprintImplementableEvent)
+	void ShowDirectionArrows(const TArray<int>& directions);
+	void ShowDirectionArrows_Implementation(const TArray<int>& directions) {}
+	UFUNCTION(BlueprintImplementableEvent)
+	void SetDirectionArrowsOpacity(const float inOpacity);
+	void SetDirectionArrowsOpacity_Implementation(const float inOpacity) {}
+
+	UFUNCTION(BlueprintImplementableEvent)
+	void ShowThankDelivery();
+	void ShowThankDelivery_Implementation() {}
+
+	// Called with the trigger of the delivery just made once the next one is placed. It no longer collides, and by
+	// default is hidden after mDeliveryTriggerFadeSeconds. Override to fade it out, it is reused two deliveries later.
+	UFUNCTION(BlueprintNativeEvent)
+	void FadeOutDeliveryTrigger(AActor* inTrigger);
+	void FadeOutDeliveryTrigger_Implementation(AActor* inTrigger);
+
+	// Called with the content of the current delivery once it is loaded, which is usually as soon as it is generated
+	UFUNCTION(BlueprintImplementableEvent)
+	void SetDeliveryContent(UPaperSprite* inGrannySprite, UPaperSprite* inThankYouSprite, UParticleSystem* inParticles);
+	void SetDeliveryContent_Implementation(UPaperSprite* inGrannySprite, UPaperSprite* inThankYouSprite, UParticleSystem* inParticles) {}
+
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnPausePressedBP();
+	void OnPausePressedBP_Implementation() {}
+
+	UFUNCTION(BlueprintImplementableEvent)
+	void SetAnimationRate(const float inAnimationRate);
+	void SetAnimationRate_Implementation(const float inAnimationRate) {}
+
+	UFUNCTION(BlueprintImplementableEvent)
+	void SetRemainingTime(const float inRemainingTime);
+	void SetRemainingTime_Implementation(const float inRemainingTime) {}
+
+	UFUNCTION(BlueprintImplementableEvent)
+	void SetScore(const float inScore);
+	void SetScore_Implementation(const float inScore) {}
+
+	// Called at most once per frame with every HUD field that changed since the previous push. By default it forwards
+	// those fields to SetRemainingTime, SetAnimationRate and SetDirectionArrowsOpacity.
+	UFUNCTION(BlueprintNativeEvent)
+	void PushHudState(const FGameJam2021HudState& inHudState, UPARAM(meta = (Bitmask, BitmaskEnum = EGameJam2021HudField)) int32 inChangedFields);
+	void PushHudState_Implementation(const FGameJam2021HudState& inHudState, int32 inChangedFields);
+
+	UFUNCTION(BlueprintImplementableEvent)
+	void GoToLoseScreen();
+	void GoToLoseScreen_Implementation() {}
+
+	// Called every frame while the city around the player is built, before input is enabled, with the built fraction
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnCityBuildProgress(const float inProgress);
+	void OnCityBuildProgress_Implementation(const float inProgress) {}
+
+	// Called once the city is built, right before the first delivery is shown and input is enabled
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnCityBuilt();
+	void OnCityBuilt_Implementation() {}
+
+	UPROPERTY(EditAnywhere)
+	AActor* mNextDeliveryTrigger = nullptr;
+
+	UFUNCTION(BlueprintCallable)
+	void OnPausePressed();
+
+	// Starts a new session in the loaded map, keeping the city as it is. Meant for the retry button of the lose screen.
+	UFUNCTION(BlueprintCallable, Exec)
+	void RestartSession();
+
+	// Prints the most recent route generation events
+	UFUNCTION(Exec)
+	void DumpRouteTrace();
+
+	// Prints the delivery queue and delivery detection counters
+	UFUNCTION(Exec)
+	void DumpDeliveryStats();
+
+	// Prints how often the HUD was pushed to Blueprint
+	UFUNCTION(Exec)
+	void DumpHudStats();
+
+	// Prints the delivery variants loaded, their estimated size and how many were not loaded in time
+	UFUNCTION(Exec)
+	void DumpDeliveryContent();
+
+	// Prints the input latency measured so far, see mMeasureInputLatency
+	UFUNCTION(Exec)
+	void DumpInputLatency();
+
+	// Prints the primitive components of the world, and the sprite draw calls of the Paper2D components against
+	// the batches of the sprite instances components. Also works headless, where the RHI draw calls are not counted.
+	UFUNCTION(Exec)
+	void DumpRenderStats();
+
+	// Compares the baked curves against evaluating the curve assets, in error and time per evaluation
+	UFUNCTION(Exec)
+	void BenchmarkCurveLUTs(int32 inNumEvaluations = 1000000);
+
+	// Times the crowd simulation and sprite instance update for 10, 100 and 1000 pedestrians
+	UFUNCTION(Exec)
+	void BenchmarkCrowd(int32 inNumSteps = 600);
+
+	// Times the character movement against the kinematic bike movement for this many bikes riding at once
+	UFUNCTION(Exec)
+	void BenchmarkBikeMovement(int32 inNumBikes = 100, int32 inNumFrames = 300);
+
+	// Times street path queries toward a few goals one by one on the game thread against one batch on workers
+	UFUNCTION(Exec)
+	void BenchmarkPathfinding(int32 inNumQueries = 1000, int32 inNumGoals = 4);
+
+protected:
+	using EDirection = RouteCore::EDirection;
+
+	using FRouteState = RouteCore::FRouteState;
+	using FDeliveryRoute = RouteCore::FDeliveryRoute;
+
+	void InitializeOnFirstTick();
+	void StartSession();
+	void UpdateCityStreaming();
+	void UpdateBikeInterpolation(const float inStepAlpha);
+	void UpdateCityBuild();
+	void SpawnCrowd();
+	UGameJam2021BikeMovementComponent* AddKinematicBikeMovement(ACharacter* inCharacter) const;
+	void UpdateGridDeliveryDetection();
+	void FlushHudState();
+	void BeginInputRecordingOrReplay();
+	void UpdateInputRecordingOrReplay(float& ioDeltaTime);
+	uint8 GetInputBits() const;
+	uint8 GetTapBits() const;
+	void ApplyInputBits(const uint8 inInputBits);
+	void PressButton(const FGameJam2021InputTimeline::EButton inButton, const FKey& inKey);
+	void ReleaseButton(const FGameJam2021InputTimeline::EButton inButton, const FKey& inKey);
+	double GetInputEventTime(const FKey& inKey, const bool inIsPress) const;
+	void UpdateInputLatency();
+	void UpdateAutopilot(const float inDeltaTime);
+	void SimulateStep(const float inStepSeconds);
+	void SetAutopilotRoute(const FRouteState& inStartState, const FDeliveryRoute& inRoute);
+	void ReportCityStats() const;
+	virtual void EndPlay(const EEndPlayReason::Type inEndPlayReason) override;
+	virtual void PlayerTick(float inDeltaTime) override;
+	virtual void SetupInputComponent() override;
+	virtual bool InputKey(FKey inKey, EInputEvent inEventType, float inAmountDepressed, bool inGamepad) override;
+
+	void GoForwardPressed(FKey inKey);
+	void GoBackPressed(FKey inKey);
+	void TurnLeftPressed(FKey inKey);
+	void TurnRightPressed(FKey inKey);
+	void GoForwardReleased(FKey inKey);
+	void GoBackReleased(FKey inKey);
+	void TurnLeftReleased(FKey inKey);
+	void TurnRightReleased(FKey inKey);
+	void OnSteeringAxis(float inValue);
+	void OnThrottleAxis(float inValue);
+
+	void GenerateNextDelivery(const EDirection & inStartFaceDirection, const bool inIsFirstDelivery = false);
+
+private:
+	RouteCore::FCityLayout GetCityLayout() const;
+	FString GetDirectionString(const EDirection& inDirection) const;
+
+	FGameJam2021CityGrid mCityGrid;
+	FIntPoint mStreamingCenterCell = FIntPoint(INDEX_NONE, INDEX_NONE);
+
+	FIntPoint mNextDeliveryGridPosition = FIntPoint(0, 0);
+	EDirection mNextDeliveryBuildingSide = EDirection::FORWARD;
+	FRandomStream mRandomStream;
+	FGameJam2021InputRecording mInputRecording;
+	FGameJam2021Autopilot mAutopilot;
+	RouteCore::FRouteGenerator mRouteGenerator;
+	RouteCore::FRouteTrace mRouteTrace;
+	FGameJam2021DeliveryQueue mDeliveryQueue;
+	FGameJam2021StreetPathfinding mStreetPathfinding;
+	FGameJam2021DeliveryContent mDeliveryContent;
+
+	// Delivery trigger index of the target building side while the character is at it, INDEX_NONE otherwise
+	int mCurrentDeliveryZone = INDEX_NONE;
+	int mNumOverlapCallbacks = 0;
+	int mNumOverlapCallbacksAvoided = 0;
+
+	// Bike controls, and when the message pump delivered the last press and release of every key. The action
+	// handlers only run later, in PlayerTick.
+	FGameJam2021InputTimeline mInputTimeline;
+	TMap<FKey, TPair<double, double>> mKeyEventTimes;
+	bool mIsApplyingInputBits = false;
+
+	// Input latency measurement, from the press being measured to the bike moving or turning
+	struct FInputLatency
+	{
+		bool mIsPending = false;
+		double mPressTime = 0.0;
+		uint64 mPressFrame = 0;
+		FVector mLocation = FVector::ZeroVector;
+		float mYaw = 0.0f;
+
+		int mNumSamples = 0;
+		uint64 mTotalFrames = 0;
+		double mTotalMs = 0.0;
+		double mMaxMs = 0.0;
+	};
+	FInputLatency mInputLatency;
+
+	bool mFirstTick = true;
+	bool mIsGameOver = false;
+
+	// The city is built over several frames before the first session starts
+	bool mIsBuildingCity = false;
+	uint64 mCityBuildStartCycles = 0;
+	int mNumCityBuildFrames = 0;
+	int mNumCityBuildChunks = 0;
+	double mLongestCityBuildFrameSeconds = 0.0;
+
+	// Where the pawn starts every session, and when the last RestartSession started, 0 once it was reported
+	FTransform mCharacterStartTransform;
+	FRotator mStartControlRotation;
+	uint64 mRestartStartCycles = 0;
+
+	// Gameplay state, only advanced by SimulateStep. The state before the last step is kept to interpolate what is shown.
+	struct FSimulationState
+	{
+		float mRemainingTime = 0.0f;
+		float mScore = 0.0f;
+		float mTimeStunned = 0.0f;
+		bool mIsStunned = true;
+		float mTimeSinceShowArrows = 0.0f;
+		FTransform mBikeTransform = FTransform::Identity; // Where the step left the bike
+	};
+	FSimulationState mSimulation;
+	FSimulationState mPreviousSimulation;
+	float mSimulationTimeAccumulator = 0.0f;
+
+	float mPreviousTotalRemainingTime = 25.0;
+
+	FGameJam2021FloatCurveLUT mDirectionArrowsOpacityLUT;
+
+	// HUD state built during the frame and the last one pushed to Blueprint
+	FGameJam2021HudState mHudState;
+	FGameJam2021HudState mPushedHudState;
+	bool mIsHudStatePushed = false;
+
+	// HUD counters of the last frame and since the start, a field update is a Blueprint call that invalidates a widget
+	int mNumHudBlueprintCallsLastFrame = 0;
+	int mNumHudFieldUpdatesLastFrame = 0;
+	int64 mNumHudFrames = 0;
+	int64 mNumHudPushes = 0;
+	int64 mNumHudBlueprintCalls = 0;
+	int64 mNumHudFieldUpdates = 0;
+
+	ACharacter* mCharacter = nullptr;
+	UCapsuleComponent *mCharacterCapsule = nullptr;
+	UCharacterMovementComponent* mCharacterMovement = nullptr;
+	UPawnMovementComponent* mBikeMovement = nullptr; // Either mCharacterMovement or the kinematic bike movement
+	float mInvCharacterMaxSpeed = 0.0f; // Cached, the bike only ever walks
+	USceneComponent* mRotationComp = nullptr;
+
+	// Components attached to the bike root and their relative transforms, offset every frame to show the bike between steps
+	TArray<USceneComponent*> mBikeVisualComponents;
+	TArray<FTransform> mBikeVisualTransforms;
+	AGameJam2021Crowd* mCrowd = nullptr;
+};
+
+
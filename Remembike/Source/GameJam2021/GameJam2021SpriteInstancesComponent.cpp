@@ -0,0 +1,158 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021SpriteInstancesComponent.h"
+#include "GameJam2021Stats.h"
+#include "PaperFlipbook.h"
+#include "PaperSprite.h"
+
+UGameJam2021SpriteInstancesComponent::UGameJam2021SpriteInstancesComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+}
+
+int32 UGameJam2021SpriteInstancesComponent::AddSpriteInstance(const FTransform& inTransform, UPaperSprite* inSprite, const bool inWorldSpace, const FLinearColor& inColor)
+{
+	const int32 instance_index = AddInstance(inTransform, inSprite, inWorldSpace, inColor);
+	mInstanceFlipbooks.SetNumZeroed(instance_index + 1);
+	mInstancePlayRates.SetNumZeroed(instance_index + 1);
+	mInstanceTimes.SetNumZeroed(instance_index + 1);
+	mInstanceFrames.SetNumZeroed(instance_index + 1);
+	mNumBatches = INDEX_NONE;
+	return instance_index;
+}
+
+int32 UGameJam2021SpriteInstancesComponent::AddFlipbookInstance(const FTransform& inTransform, UPaperFlipbook* inFlipbook, const float inPlayRate, const bool inWorldSpace, const float inStartTime)
+{
+	const float duration = (inFlipbook ? inFlipbook->GetTotalDuration() : 0.0f);
+	const float start_time = (duration > 0.0f ? FMath::Fmod(FMath::Max(inStartTime, 0.0f), duration) : 0.0f);
+	const int32 start_frame = (inFlipbook ? inFlipbook->GetKeyFrameIndexAtTime(start_time) : 0);
+	const int32 instance_index = AddSpriteInstance(inTransform, inFlipbook ? inFlipbook->GetSpriteAtFrame(start_frame) : nullptr, inWorldSpace);
+	mInstanceFlipbooks[instance_index] = inFlipbook;
+	mInstancePlayRates[instance_index] = inPlayRate;
+	mInstanceTimes[instance_index] = start_time;
+	mInstanceFrames[instance_index] = start_frame;
+	return instance_index;
+}
+
+bool UGameJam2021SpriteInstancesComponent::RemoveSpriteInstance(const int32 inInstanceIndex)
+{
+	if (!RemoveInstance(inInstanceIndex))
+		return false;
+
+	if (mInstanceFlipbooks.IsValidIndex(inInstanceIndex))
+	{
+		mInstanceFlipbooks.RemoveAt(inInstanceIndex);
+		mInstancePlayRates.RemoveAt(inInstanceIndex);
+		mInstanceTimes.RemoveAt(inInstanceIndex);
+		mInstanceFrames.RemoveAt(inInstanceIndex);
+	}
+	mNumBatches = INDEX_NONE;
+	return true;
+}
+
+void UGameJam2021SpriteInstancesComponent::ClearSpriteInstances()
+{
+	ClearInstances();
+	mInstanceFlipbooks.Reset();
+	mInstancePlayRates.Reset();
+	mInstanceTimes.Reset();
+	mInstanceFrames.Reset();
+	mNumBatches = 0;
+}
+
+bool UGameJam2021SpriteInstancesComponent::SetInstanceFrame(const int32 inInstanceIndex, const int32 inFrame)
+{
+	if (!mInstanceFlipbooks.IsValidIndex(inInstanceIndex) || !PerInstanceSpriteData.IsValidIndex(inInstanceIndex))
+		return false;
+
+	const UPaperFlipbook* flipbook = mInstanceFlipbooks[inInstanceIndex];
+	const int32 num_key_frames = (flipbook ? flipbook->GetNumKeyFrames() : 0);
+	if (num_key_frames == 0)
+		return false;
+
+	const int32 frame = inFrame % num_key_frames;
+	if (frame == mInstanceFrames[inInstanceIndex])
+		return false;
+
+	// Only the sprite pointer changes, the material index stays valid as long as the frames share a material
+	mInstanceFrames[inInstanceIndex] = frame;
+	FSpriteInstanceData& instance_data = PerInstanceSpriteData[inInstanceIndex];
+	UPaperSprite* sprite = flipbook->GetSpriteAtFrame(frame);
+	if (instance_data.SourceSprite == sprite)
+		return false;
+
+	instance_data.SourceSprite = sprite;
+	mNumBatches = INDEX_NONE;
+	++mNumFrameChanges;
+	return true;
+}
+
+void UGameJam2021SpriteInstancesComponent::SetInstancePlayRate(const int32 inInstanceIndex, const float inPlayRate)
+{
+	if (mInstancePlayRates.IsValidIndex(inInstanceIndex))
+		mInstancePlayRates[inInstanceIndex] = inPlayRate;
+}
+
+void UGameJam2021SpriteInstancesComponent::SetPlayRate(const float inPlayRate)
+{
+	for (int instance_i = 0; instance_i < mInstanceFlipbooks.Num(); ++instance_i)
+	{
+		if (mInstanceFlipbooks[instance_i])
+			mInstancePlayRates[instance_i] = inPlayRate;
+	}
+}
+
+void UGameJam2021SpriteInstancesComponent::AdvanceAnimations(const float inDeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RemembikeSpriteAnimation);
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameJam2021SpriteInstancesComponent::AdvanceAnimations);
+
+	bool is_frame_changed = false;
+	const int num_instances = FMath::Min(mInstanceFlipbooks.Num(), PerInstanceSpriteData.Num());
+	for (int instance_i = 0; instance_i < num_instances; ++instance_i)
+	{
+		const UPaperFlipbook* flipbook = mInstanceFlipbooks[instance_i];
+		const float play_rate = mInstancePlayRates[instance_i];
+		if (!flipbook || play_rate == 0.0f)
+			continue;
+
+		const float duration = flipbook->GetTotalDuration();
+		if (duration <= 0.0f)
+			continue;
+
+		float& time = mInstanceTimes[instance_i];
+		time = FMath::Fmod(time + inDeltaTime * play_rate, duration);
+		if (time < 0.0f)
+			time += duration;
+		is_frame_changed |= SetInstanceFrame(instance_i, flipbook->GetKeyFrameIndexAtTime(time));
+	}
+
+	if (is_frame_changed)
+		MarkRenderStateDirty();
+}
+
+void UGameJam2021SpriteInstancesComponent::TickComponent(float inDeltaTime, enum ELevelTick inTickType, FActorComponentTickFunction* inThisTickFunction)
+{
+	Super::TickComponent(inDeltaTime, inTickType, inThisTickFunction);
+
+	AdvanceAnimations(inDeltaTime);
+
+	INC_DWORD_STAT_BY(STAT_RemembikeSpriteInstances, GetInstanceCount());
+	INC_DWORD_STAT_BY(STAT_RemembikeSpriteBatches, GetNumBatches());
+}
+
+int UGameJam2021SpriteInstancesComponent::GetNumBatches() const
+{
+	if (mNumBatches != INDEX_NONE)
+		return mNumBatches;
+
+	// Same grouping as the scene proxy, which draws the instances of each texture and material together
+	TSet<TPair<const UTexture*, const UMaterialInterface*>> batches;
+	for (const FSpriteInstanceData& instance_data : PerInstanceSpriteData)
+	{
+		if (instance_data.SourceSprite)
+			batches.Add(TPair<const UTexture*, const UMaterialInterface*>(instance_data.SourceSprite->GetBakedTexture(), GetMaterial(instance_data.MaterialIndex)));
+	}
+	mNumBatches = batches.Num();
+	return mNumBatches;
+}
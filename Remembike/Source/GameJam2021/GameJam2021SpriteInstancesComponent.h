@@ -0,0 +1,65 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PaperGroupedSpriteComponent.h"
+#include "GameJam2021SpriteInstancesComponent.generated.h"
+
+class UPaperFlipbook;
+
+// Grouped sprite component whose instances can also play flipbooks. The frame of every instance is picked from
+// per-instance arrays, either by the owner with SetInstanceFrame or by the tick from the instance play time and
+// rate, and only swaps the sprite of that instance. All the instances are drawn by this one component, in one
+// batch per texture and material, so frames of a flipbook should come from the same atlas.
+// The per-instance arrays are only kept in sync by the methods below, instances added or removed through the
+// base class methods have no flipbook.
+UCLASS(ClassGroup = Paper2D, meta = (BlueprintSpawnableComponent))
+class UGameJam2021SpriteInstancesComponent : public UPaperGroupedSpriteComponent
+{
+	GENERATED_BODY()
+
+public:
+	UGameJam2021SpriteInstancesComponent();
+
+	int32 AddSpriteInstance(const FTransform& inTransform, UPaperSprite* inSprite, const bool inWorldSpace = false, const FLinearColor& inColor = FLinearColor::White);
+
+	// Instance showing inFlipbook at inStartTime, played at inPlayRate times its frame rate by the tick, 0 leaves the
+	// frame to SetInstanceFrame
+	int32 AddFlipbookInstance(const FTransform& inTransform, UPaperFlipbook* inFlipbook, const float inPlayRate = 1.0f, const bool inWorldSpace = false, const float inStartTime = 0.0f);
+
+	bool RemoveSpriteInstance(const int32 inInstanceIndex);
+	void ClearSpriteInstances();
+
+	// inFrame is a key frame index, wrapped around the key frames of the instance flipbook. Returns true if the instance now shows another sprite, the
+	// render state is then left for the caller to mark dirty once for all the changes.
+	bool SetInstanceFrame(const int32 inInstanceIndex, const int32 inFrame);
+
+	UFUNCTION(BlueprintCallable)
+	void SetInstancePlayRate(const int32 inInstanceIndex, const float inPlayRate);
+
+	// Same rate for every flipbook instance, the array counterpart of one SetAnimationRate call per actor
+	UFUNCTION(BlueprintCallable)
+	void SetPlayRate(const float inPlayRate);
+
+	// Advances the flipbook instances with a play rate, and marks the render state dirty if any frame changed
+	void AdvanceAnimations(const float inDeltaTime);
+
+	virtual void TickComponent(float inDeltaTime, enum ELevelTick inTickType, FActorComponentTickFunction* inThisTickFunction) override;
+
+	// Mesh batches the scene proxy draws, one per distinct texture and material of the instances
+	int GetNumBatches() const;
+
+	int GetNumFrameChanges() const { return mNumFrameChanges; }
+
+private:
+	// Per instance, all as long as PerInstanceSpriteData. Instances added with AddSpriteInstance have no flipbook.
+	UPROPERTY(Transient)
+	TArray<UPaperFlipbook*> mInstanceFlipbooks;
+	TArray<float> mInstancePlayRates;
+	TArray<float> mInstanceTimes;
+	TArray<int32> mInstanceFrames;
+
+	int mNumFrameChanges = 0;
+	mutable int mNumBatches = 0; // INDEX_NONE until counted again after a sprite changed
+};
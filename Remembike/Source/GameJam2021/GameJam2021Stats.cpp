@@ -0,0 +1,28 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021Stats.h"
+
+DEFINE_STAT(STAT_RemembikePlayerTick);
+DEFINE_STAT(STAT_RemembikeInitializeOnFirstTick);
+DEFINE_STAT(STAT_RemembikeGenerateNextDelivery);
+DEFINE_STAT(STAT_RemembikeOnOverlap);
+DEFINE_STAT(STAT_RemembikeCityStreaming);
+DEFINE_STAT(STAT_RemembikeCrowdSimulation);
+DEFINE_STAT(STAT_RemembikeCrowdInstances);
+DEFINE_STAT(STAT_RemembikeBikeMovement);
+DEFINE_STAT(STAT_RemembikeStreetPathfinding);
+DEFINE_STAT(STAT_RemembikeSpriteAnimation);
+
+DEFINE_STAT(STAT_RemembikeSyncRoutes);
+DEFINE_STAT(STAT_RemembikeRouteStatesVisited);
+DEFINE_STAT(STAT_RemembikeRouteMovesRejected);
+DEFINE_STAT(STAT_RemembikeHudEvents);
+DEFINE_STAT(STAT_RemembikeOverlapCallbacks);
+DEFINE_STAT(STAT_RemembikeOverlapCallbacksAvoided);
+DEFINE_STAT(STAT_RemembikeSpriteInstances);
+DEFINE_STAT(STAT_RemembikeSpriteBatches);
+
+DEFINE_STAT(STAT_RemembikeCityActors);
+DEFINE_STAT(STAT_RemembikeCityChunks);
+
+CSV_DEFINE_CATEGORY(Remembike, true);
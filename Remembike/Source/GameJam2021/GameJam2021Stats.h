@@ -0,0 +1,38 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+// "stat Remembike" in the console shows these, -csvprofile records the Remembike CSV category
+DECLARE_STATS_GROUP(TEXT("Remembike"), STATGROUP_Remembike, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PlayerTick"), STAT_RemembikePlayerTick, STATGROUP_Remembike, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("InitializeOnFirstTick"), STAT_RemembikeInitializeOnFirstTick, STATGROUP_Remembike, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GenerateNextDelivery"), STAT_RemembikeGenerateNextDelivery, STATGROUP_Remembike, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("OnOverlap"), STAT_RemembikeOnOverlap, STATGROUP_Remembike, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("City streaming"), STAT_RemembikeCityStreaming, STATGROUP_Remembike, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Crowd simulation"), STAT_RemembikeCrowdSimulation, STATGROUP_Remembike, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Crowd instances"), STAT_RemembikeCrowdInstances, STATGROUP_Remembike, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Bike movement"), STAT_RemembikeBikeMovement, STATGROUP_Remembike, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Street pathfinding"), STAT_RemembikeStreetPathfinding, STATGROUP_Remembike, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sprite animation"), STAT_RemembikeSpriteAnimation, STATGROUP_Remembike, );
+
+// Per frame counters
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Routes generated synchronously"), STAT_RemembikeSyncRoutes, STATGROUP_Remembike, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Route states visited"), STAT_RemembikeRouteStatesVisited, STATGROUP_Remembike, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Route moves rejected"), STAT_RemembikeRouteMovesRejected, STATGROUP_Remembike, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("HUD Blueprint events"), STAT_RemembikeHudEvents, STATGROUP_Remembike, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Overlap callbacks"), STAT_RemembikeOverlapCallbacks, STATGROUP_Remembike, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Overlap callbacks avoided"), STAT_RemembikeOverlapCallbacksAvoided, STATGROUP_Remembike, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sprite instances"), STAT_RemembikeSpriteInstances, STATGROUP_Remembike, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sprite instance batches"), STAT_RemembikeSpriteBatches, STATGROUP_Remembike, );
+
+// Running totals
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("City actors spawned"), STAT_RemembikeCityActors, STATGROUP_Remembike, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("City chunks materialized"), STAT_RemembikeCityChunks, STATGROUP_Remembike, );
+
+CSV_DECLARE_CATEGORY_EXTERN(Remembike);
@@ -0,0 +1,268 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "GameJam2021StreetPathfinding.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "GameJam2021Stats.h"
+
+namespace
+{
+	bool IsSameGoal(const RouteCore::FStreetFlowField& inFlowField, const RouteCore::FGridPosition& inGoalCell, const RouteCore::EDirection inGoalSide)
+	{
+		return inFlowField.GetGoalCell() == inGoalCell && inFlowField.GetGoalSide() == inGoalSide;
+	}
+}
+
+void FGameJam2021StreetPathfinding::Initialize(const int inGridSize, const int inMaxFlowFields, const int inMinFlowFieldRequests)
+{
+	// Batches still running keep the previous graph alive
+	mPathfinder.Reset();
+	mShared = MakeShared<FShared, ESPMode::ThreadSafe>(inGridSize);
+	mShared->mMaxFlowFields = FMath::Max(inMaxFlowFields, 0);
+	mShared->mMinFlowFieldRequests = FMath::Max(inMinFlowFieldRequests, 1);
+	mPathfinder = MakeUnique<RouteCore::FStreetPathfinder>(mShared->mGraph);
+}
+
+void FGameJam2021StreetPathfinding::CacheFlowField(const FGridPosition& inGoalCell, const EDirection inGoalSide)
+{
+	if (mShared && mShared->mGraph.IsInside(inGoalCell) && !mShared->FindFlowField(inGoalCell, inGoalSide))
+		mShared->BuildFlowField(inGoalCell, inGoalSide);
+}
+
+FGameJam2021PathResult FGameJam2021StreetPathfinding::FindPath(const FGameJam2021PathRequest& inRequest)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RemembikeStreetPathfinding);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FGameJam2021StreetPathfinding::FindPath);
+
+	FGameJam2021PathResult result;
+	if (!mShared)
+		return result;
+
+	const FFlowFieldPtr flow_field = mShared->FindFlowField(inRequest.mGoalCell, inRequest.mGoalSide);
+	if (flow_field)
+	{
+		result.mIsFound = flow_field->GetPath(mShared->mGraph, inRequest.mStartState, result.mPath);
+		result.mIsFromFlowField = true;
+	}
+	else
+	{
+		result.mIsFound = mPathfinder->FindPath(inRequest.mStartState, inRequest.mGoalCell, inRequest.mGoalSide, result.mPath);
+	}
+	return result;
+}
+
+TFuture<TArray<FGameJam2021PathResult>> FGameJam2021StreetPathfinding::FindPathsAsync(TArray<FGameJam2021PathRequest> inRequests) const
+{
+	if (!mShared)
+	{
+		TArray<FGameJam2021PathResult> results;
+		results.SetNum(inRequests.Num());
+		TPromise<TArray<FGameJam2021PathResult>> promise;
+		promise.SetValue(MoveTemp(results));
+		return promise.GetFuture();
+	}
+
+	// Only the shared state is captured, the service can be initialized again or destroyed while the batch runs
+	return Async(EAsyncExecution::TaskGraph, [shared = mShared, requests = MoveTemp(inRequests)]()
+	{
+		return FindPaths(*shared, requests);
+	});
+}
+
+TArray<FGameJam2021PathResult> FGameJam2021StreetPathfinding::FindPaths(FShared& ioShared, const TArray<FGameJam2021PathRequest>& inRequests)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RemembikeStreetPathfinding);
+	TRACE_CPUPROFILER_EVENT_SCOPE(FGameJam2021StreetPathfinding::FindPaths);
+
+	const RouteCore::FStreetGraph& graph = ioShared.mGraph;
+	TArray<FGameJam2021PathResult> results;
+	results.SetNum(inRequests.Num());
+
+	// Requests grouped by goal, keyed by the state of the goal facing forward. Goals outside the grid are never found.
+	TMap<int32, TArray<int32>> goal_requests;
+	for (int request_i = 0; request_i < inRequests.Num(); ++request_i)
+	{
+		const FGameJam2021PathRequest& request = inRequests[request_i];
+		if (!graph.IsInside(request.mGoalCell))
+			continue;
+
+		FRouteState goal_state;
+		goal_state.mGridPosition = request.mGoalCell;
+		goal_state.mBuildingSide = request.mGoalSide;
+		goal_requests.FindOrAdd(graph.GetStateIndex(goal_state)).Add(request_i);
+	}
+
+	TArray<int32> astar_requests;
+	for (const TPair<int32, TArray<int32>>& goal : goal_requests)
+	{
+		const FGameJam2021PathRequest& goal_request = inRequests[goal.Value[0]];
+		FFlowFieldPtr flow_field = ioShared.FindFlowField(goal_request.mGoalCell, goal_request.mGoalSide);
+		if (!flow_field && goal.Value.Num() >= ioShared.mMinFlowFieldRequests)
+			flow_field = ioShared.BuildFlowField(goal_request.mGoalCell, goal_request.mGoalSide);
+
+		if (!flow_field)
+		{
+			astar_requests.Append(goal.Value);
+			continue;
+		}
+
+		for (const int32 request_i : goal.Value)
+		{
+			FGameJam2021PathResult& result = results[request_i];
+			result.mIsFound = flow_field->GetPath(graph, inRequests[request_i].mStartState, result.mPath);
+			result.mIsFromFlowField = true;
+		}
+	}
+
+	// One slice per worker, each with a pathfinder of the pool
+	const int num_slices = FMath::Min(astar_requests.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+	ParallelFor(num_slices, [&ioShared, &inRequests, &astar_requests, &results, num_slices](int32 inSlice)
+	{
+		TUniquePtr<RouteCore::FStreetPathfinder> pathfinder = ioShared.AcquirePathfinder();
+		const int begin = astar_requests.Num() * inSlice / num_slices;
+		const int end = astar_requests.Num() * (inSlice + 1) / num_slices;
+		for (int astar_request_i = begin; astar_request_i < end; ++astar_request_i)
+		{
+			const int32 request_i = astar_requests[astar_request_i];
+			const FGameJam2021PathRequest& request = inRequests[request_i];
+			results[request_i].mIsFound = pathfinder->FindPath(request.mStartState, request.mGoalCell, request.mGoalSide, results[request_i].mPath);
+		}
+		ioShared.ReleasePathfinder(MoveTemp(pathfinder));
+	});
+	return results;
+}
+
+TUniquePtr<RouteCore::FStreetPathfinder> FGameJam2021StreetPathfinding::FShared::AcquirePathfinder()
+{
+	{
+		FScopeLock lock(&mPathfindersLock);
+		if (mIdlePathfinders.Num() > 0)
+			return mIdlePathfinders.Pop(false);
+	}
+
+	// Only allocated when more slices run at once than ever before
+	return MakeUnique<RouteCore::FStreetPathfinder>(mGraph);
+}
+
+void FGameJam2021StreetPathfinding::FShared::ReleasePathfinder(TUniquePtr<RouteCore::FStreetPathfinder> inPathfinder)
+{
+	FScopeLock lock(&mPathfindersLock);
+	mIdlePathfinders.Add(MoveTemp(inPathfinder));
+}
+
+FGameJam2021StreetPathfinding::FFlowFieldPtr FGameJam2021StreetPathfinding::FShared::FindFlowField(const FGridPosition& inGoalCell, const EDirection inGoalSide)
+{
+	FScopeLock lock(&mFlowFieldsLock);
+	const int flow_field_i = mFlowFields.IndexOfByPredicate([&inGoalCell, inGoalSide](const FFlowFieldPtr& inFlowField)
+	{
+		return IsSameGoal(*inFlowField, inGoalCell, inGoalSide);
+	});
+	if (flow_field_i == INDEX_NONE)
+		return nullptr;
+
+	FFlowFieldPtr flow_field = mFlowFields[flow_field_i];
+	mFlowFields.RemoveAt(flow_field_i, 1, false);
+	mFlowFields.Add(flow_field);
+	return flow_field;
+}
+
+FGameJam2021StreetPathfinding::FFlowFieldPtr FGameJam2021StreetPathfinding::FShared::BuildFlowField(const FGridPosition& inGoalCell, const EDirection inGoalSide)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FGameJam2021StreetPathfinding::BuildFlowField);
+
+	// Built outside the lock, if another batch built the same field meanwhile the first one is kept
+	TSharedRef<RouteCore::FStreetFlowField, ESPMode::ThreadSafe> built_flow_field = MakeShared<RouteCore::FStreetFlowField, ESPMode::ThreadSafe>();
+	built_flow_field->Build(mGraph, inGoalCell, inGoalSide);
+	FFlowFieldPtr flow_field = built_flow_field;
+
+	FScopeLock lock(&mFlowFieldsLock);
+	if (mMaxFlowFields == 0)
+		return flow_field;
+
+	const FFlowFieldPtr* cached_flow_field = mFlowFields.FindByPredicate([&inGoalCell, inGoalSide](const FFlowFieldPtr& inFlowField)
+	{
+		return IsSameGoal(*inFlowField, inGoalCell, inGoalSide);
+	});
+	if (cached_flow_field)
+		return *cached_flow_field;
+
+	// Evicted fields live on in the batches still reading them
+	if (mFlowFields.Num() >= mMaxFlowFields)
+		mFlowFields.RemoveAt(0, mFlowFields.Num() - mMaxFlowFields + 1, false);
+	mFlowFields.Add(flow_field);
+	return flow_field;
+}
+
+FGameJam2021StreetPathfinding::FRouteState FGameJam2021StreetPathfinding::GetStateAt(const RouteCore::FCityLayout& inLayout, const FVector& inLocation, const FVector& inForward)
+{
+	RouteCore::FWorldPosition world_position;
+	world_position.X = inLocation.X;
+	world_position.Y = inLocation.Y;
+	const FGridPosition cell = inLayout.GetGridPosition(world_position);
+
+	FRouteState state;
+	state.mGridPosition = FGridPosition(FMath::Clamp(cell.X, 0, inLayout.mGridSize - 1), FMath::Clamp(cell.Y, 0, inLayout.mGridSize - 1));
+
+	// The grid is transposed, grid Y goes along world X. Streets run across the direction of the building side.
+	const RouteCore::FWorldPosition center = inLayout.GetGridWorldPosition(state.mGridPosition);
+	const FVector2D offset(inLocation.X - center.X, inLocation.Y - center.Y);
+	if (FMath::Abs(offset.X) >= FMath::Abs(offset.Y))
+	{
+		state.mBuildingSide = (offset.X >= 0.0f ? EDirection::FORWARD : EDirection::BACK);
+		state.mFacingDirection = (inForward.Y >= 0.0f ? EDirection::RIGHT : EDirection::LEFT);
+	}
+	else
+	{
+		state.mBuildingSide = (offset.Y >= 0.0f ? EDirection::RIGHT : EDirection::LEFT);
+		state.mFacingDirection = (inForward.X >= 0.0f ? EDirection::FORWARD : EDirection::BACK);
+	}
+	return state;
+}
+
+void FGameJam2021StreetPathfinding::GetWaypoints(const RouteCore::FCityLayout& inLayout, const FRouteState& inStartState, const RouteCore::FStreetPath& inPath, TArray<FVector>& outWaypoints) const
+{
+	outWaypoints.Reset(static_cast<int32>(inPath.mDirections.size()));
+	if (!mShared || !mShared->mGraph.IsInside(inStartState.mGridPosition))
+		return;
+
+	const RouteCore::FStreetGraph& graph = mShared->mGraph;
+	int state_i = graph.GetStateIndex(inStartState);
+	for (const EDirection direction : inPath.mDirections)
+	{
+		const int move = RouteCore::FStreetGraph::GetMove(direction);
+		if (move == RouteCore::FStreetGraph::NumMoves || graph.GetNextState(state_i, move) == RouteCore::FStreetGraph::NoState)
+			break;
+
+		state_i = graph.GetNextState(state_i, move);
+		const FRouteState state = graph.GetState(state_i);
+		const RouteCore::FWorldPosition world_position = inLayout.GetGridWorldPosition(state.mGridPosition, state.mBuildingSide);
+		outWaypoints.Add(FVector(world_position.X, world_position.Y, 0.0f));
+	}
+}
+
+int FGameJam2021StreetPathfinding::GetNumCachedFlowFields() const
+{
+	if (!mShared)
+		return 0;
+
+	FScopeLock lock(&mShared->mFlowFieldsLock);
+	return mShared->mFlowFields.Num();
+}
+
+SIZE_T FGameJam2021StreetPathfinding::GetAllocatedBytes() const
+{
+	if (!mShared)
+		return 0;
+
+	// Pathfinders busy in a batch are not counted
+	SIZE_T allocated_bytes = mShared->mGraph.GetAllocatedBytes() + (mPathfinder ? mPathfinder->GetAllocatedBytes() : 0);
+	{
+		FScopeLock lock(&mShared->mFlowFieldsLock);
+		for (const FFlowFieldPtr& flow_field : mShared->mFlowFields)
+			allocated_bytes += flow_field->GetAllocatedBytes();
+	}
+	FScopeLock lock(&mShared->mPathfindersLock);
+	for (const TUniquePtr<RouteCore::FStreetPathfinder>& pathfinder : mShared->mIdlePathfinders)
+		allocated_bytes += pathfinder->GetAllocatedBytes();
+	return allocated_bytes;
+}
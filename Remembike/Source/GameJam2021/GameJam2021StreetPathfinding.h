@@ -0,0 +1,88 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "HAL/CriticalSection.h"
+#include "RouteCore/StreetPathfinder.h"
+
+struct FGameJam2021PathRequest
+{
+	RouteCore::FRouteState mStartState;
+	RouteCore::FGridPosition mGoalCell;
+	RouteCore::EDirection mGoalSide = RouteCore::EDirection::FORWARD;
+};
+
+struct FGameJam2021PathResult
+{
+	RouteCore::FStreetPath mPath;
+	bool mIsFound = false;
+	bool mIsFromFlowField = false;
+};
+
+// Paths along the streets for pedestrians and bots, over the same (cell, facing, side) states the deliveries are
+// generated on, so a new city layout only needs a new graph instead of a navmesh rebuild. Goals that many requests of
+// a batch share get a flow field, the most recently used ones are kept for the next batches, and the other requests
+// run A* on task graph workers.
+class FGameJam2021StreetPathfinding
+{
+public:
+	using EDirection = RouteCore::EDirection;
+	using FGridPosition = RouteCore::FGridPosition;
+	using FRouteState = RouteCore::FRouteState;
+
+	// A batch builds a flow field toward every goal it has at least inMinFlowFieldRequests requests for
+	void Initialize(const int inGridSize, const int inMaxFlowFields, const int inMinFlowFieldRequests);
+	bool IsInitialized() const { return mShared.IsValid(); }
+
+	// Builds the flow field toward a goal now, if it is not cached yet
+	void CacheFlowField(const FGridPosition& inGoalCell, const EDirection inGoalSide);
+
+	// Answers one request on the calling thread, only meant for the game thread
+	FGameJam2021PathResult FindPath(const FGameJam2021PathRequest& inRequest);
+
+	// Answers every request on task graph workers, the results are in the order of the requests. Batches can run
+	// while others do, and the future keeps everything it reads alive.
+	TFuture<TArray<FGameJam2021PathResult>> FindPathsAsync(TArray<FGameJam2021PathRequest> inRequests) const;
+
+	// Closest (cell, facing, side) state to a world position, facing the street direction closest to inForward
+	static FRouteState GetStateAt(const RouteCore::FCityLayout& inLayout, const FVector& inLocation, const FVector& inForward);
+
+	// Building side positions the path goes by, one per move
+	void GetWaypoints(const RouteCore::FCityLayout& inLayout, const FRouteState& inStartState, const RouteCore::FStreetPath& inPath, TArray<FVector>& outWaypoints) const;
+
+	int GetNumCachedFlowFields() const;
+	SIZE_T GetAllocatedBytes() const;
+
+private:
+	using FFlowFieldPtr = TSharedPtr<const RouteCore::FStreetFlowField, ESPMode::ThreadSafe>;
+
+	// Everything a batch reads, shared with the batches still running when the service is initialized again
+	struct FShared
+	{
+		explicit FShared(const int inGridSize) : mGraph(inGridSize) {}
+
+		FFlowFieldPtr FindFlowField(const FGridPosition& inGoalCell, const EDirection inGoalSide);
+		FFlowFieldPtr BuildFlowField(const FGridPosition& inGoalCell, const EDirection inGoalSide);
+		TUniquePtr<RouteCore::FStreetPathfinder> AcquirePathfinder();
+		void ReleasePathfinder(TUniquePtr<RouteCore::FStreetPathfinder> inPathfinder);
+
+		const RouteCore::FStreetGraph mGraph;
+		int mMaxFlowFields = 4;
+		int mMinFlowFieldRequests = 8;
+
+		// Most recently used last
+		mutable FCriticalSection mFlowFieldsLock;
+		TArray<FFlowFieldPtr> mFlowFields;
+
+		// A* scratch buffers are as large as the graph, so the worker pathfinders are kept for the next batches
+		mutable FCriticalSection mPathfindersLock;
+		TArray<TUniquePtr<RouteCore::FStreetPathfinder>> mIdlePathfinders;
+	};
+
+	static TArray<FGameJam2021PathResult> FindPaths(FShared& ioShared, const TArray<FGameJam2021PathRequest>& inRequests);
+
+	TSharedPtr<FShared, ESPMode::ThreadSafe> mShared;
+	TUniquePtr<RouteCore::FStreetPathfinder> mPathfinder; // Game thread only
+};
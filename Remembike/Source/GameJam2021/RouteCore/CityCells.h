@@ -0,0 +1,79 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "CityGrid.h"
+
+namespace RouteCore
+{
+	// Flat per-cell store of the whole city, one array per attribute so a pass over one attribute stays cache friendly.
+	// Cells are grouped in square chunks, which is the unit the game materializes actors in.
+	class FCityCells
+	{
+	public:
+		enum EOccupancy : std::uint8_t
+		{
+			OccupancyEmpty = 0,
+			OccupancyBuilding = 1
+		};
+
+		void Reset(const int inGridSize, const int inChunkSize)
+		{
+			mGridSize = inGridSize;
+			mChunkSize = (inChunkSize > 0 ? inChunkSize : 1);
+			mNumChunksPerSide = (mGridSize + mChunkSize - 1) / mChunkSize;
+
+			const std::size_t num_cells = static_cast<std::size_t>(mGridSize) * static_cast<std::size_t>(mGridSize);
+			mBuildingTypes.assign(num_cells, 0);
+			mOccupancy.assign(num_cells, OccupancyEmpty);
+			mTriggerSlots.assign(num_cells, 0);
+		}
+
+		int GetGridSize() const { return mGridSize; }
+		int GetNumCells() const { return mGridSize * mGridSize; }
+		int GetChunkSize() const { return mChunkSize; }
+		int GetNumChunksPerSide() const { return mNumChunksPerSide; }
+		int GetNumChunks() const { return mNumChunksPerSide * mNumChunksPerSide; }
+
+		bool IsInside(const FGridPosition& inCell) const { return inCell.X >= 0 && inCell.Y >= 0 && inCell.X < mGridSize && inCell.Y < mGridSize; }
+		int GetCellIndex(const FGridPosition& inCell) const { return inCell.Y * mGridSize + inCell.X; }
+
+		std::uint8_t GetBuildingType(const int inCellIndex) const { return mBuildingTypes[inCellIndex]; }
+		void SetBuildingType(const int inCellIndex, const std::uint8_t inBuildingType) { mBuildingTypes[inCellIndex] = inBuildingType; }
+
+		std::uint8_t GetOccupancy(const int inCellIndex) const { return mOccupancy[inCellIndex]; }
+		void SetOccupancy(const int inCellIndex, const std::uint8_t inOccupancy) { mOccupancy[inCellIndex] = inOccupancy; }
+
+		// Mask of the building sides (ToMask(EDirection)) a delivery can be made to
+		std::uint8_t GetTriggerSlots(const int inCellIndex) const { return mTriggerSlots[inCellIndex]; }
+		void SetTriggerSlots(const int inCellIndex, const std::uint8_t inTriggerSlots) { mTriggerSlots[inCellIndex] = inTriggerSlots; }
+
+		FGridPosition GetChunkOfCell(const FGridPosition& inCell) const { return FGridPosition(inCell.X / mChunkSize, inCell.Y / mChunkSize); }
+		int GetChunkIndex(const FGridPosition& inChunk) const { return inChunk.Y * mNumChunksPerSide + inChunk.X; }
+		bool IsChunkInside(const FGridPosition& inChunk) const { return inChunk.X >= 0 && inChunk.Y >= 0 && inChunk.X < mNumChunksPerSide && inChunk.Y < mNumChunksPerSide; }
+
+		// First cell of the chunk and one past its last cell, clipped to the grid
+		void GetChunkCells(const FGridPosition& inChunk, FGridPosition& outMinCell, FGridPosition& outEndCell) const
+		{
+			outMinCell = FGridPosition(inChunk.X * mChunkSize, inChunk.Y * mChunkSize);
+			outEndCell = FGridPosition(outMinCell.X + mChunkSize < mGridSize ? outMinCell.X + mChunkSize : mGridSize,
+				outMinCell.Y + mChunkSize < mGridSize ? outMinCell.Y + mChunkSize : mGridSize);
+		}
+
+		std::size_t GetAllocatedBytes() const
+		{
+			return mBuildingTypes.capacity() + mOccupancy.capacity() + mTriggerSlots.capacity();
+		}
+
+	private:
+		int mGridSize = 0;
+		int mChunkSize = 1;
+		int mNumChunksPerSide = 0;
+
+		std::vector<std::uint8_t> mBuildingTypes;
+		std::vector<std::uint8_t> mOccupancy;
+		std::vector<std::uint8_t> mTriggerSlots;
+	};
+}
@@ -0,0 +1,91 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "StreetTransitions.h"
+
+// Grid and direction helpers shared by the game and the standalone benchmark, free of engine types.
+namespace RouteCore
+{
+	struct FGridPosition
+	{
+		int X = 0;
+		int Y = 0;
+
+		constexpr FGridPosition() = default;
+		constexpr FGridPosition(const int inX, const int inY) : X(inX), Y(inY) {}
+
+		constexpr FGridPosition operator+(const FGridPosition& inOther) const { return FGridPosition(X + inOther.X, Y + inOther.Y); }
+		constexpr bool operator==(const FGridPosition& inOther) const { return X == inOther.X && Y == inOther.Y; }
+		constexpr bool operator!=(const FGridPosition& inOther) const { return !(*this == inOther); }
+	};
+
+	// World position on the ground plane. The grid is transposed, grid Y goes along world X.
+	struct FWorldPosition
+	{
+		float X = 0.0f;
+		float Y = 0.0f;
+	};
+
+	constexpr FGridPosition GetDirectionVector(const EDirection inDirection)
+	{
+		return inDirection == EDirection::FORWARD ? FGridPosition(0, 1) :
+			inDirection == EDirection::BACK ? FGridPosition(0, -1) :
+			inDirection == EDirection::LEFT ? FGridPosition(-1, 0) : FGridPosition(1, 0);
+	}
+
+	constexpr EDirection GetOppositeDirection(const EDirection inDirection)
+	{
+		return inDirection == EDirection::FORWARD ? EDirection::BACK :
+			inDirection == EDirection::BACK ? EDirection::FORWARD :
+			inDirection == EDirection::LEFT ? EDirection::RIGHT : EDirection::LEFT;
+	}
+
+	constexpr const char* GetDirectionString(const EDirection inDirection)
+	{
+		return inDirection == EDirection::FORWARD ? "FORWARD" :
+			inDirection == EDirection::BACK ? "BACK" :
+			inDirection == EDirection::LEFT ? "LEFT" : "RIGHT";
+	}
+
+	struct FCityLayout
+	{
+		int mGridSize = 6;
+		float mBuildingSize = 100.0f;
+
+		constexpr bool IsInside(const FGridPosition& inGridPosition) const
+		{
+			return inGridPosition.X >= 0 && inGridPosition.Y >= 0 && inGridPosition.X < mGridSize && inGridPosition.Y < mGridSize;
+		}
+
+		constexpr bool IsInBoundary(const FGridPosition& inGridPosition) const
+		{
+			return GetBoundaryClass(inGridPosition.X, inGridPosition.Y, mGridSize) != 0;
+		}
+
+		FWorldPosition GetGridWorldPosition(const FGridPosition& inGridPosition) const
+		{
+			FWorldPosition world_pos;
+			world_pos.X = (inGridPosition.Y - mGridSize / 2) * mBuildingSize;
+			world_pos.Y = (inGridPosition.X - mGridSize / 2) * mBuildingSize;
+			return world_pos;
+		}
+
+		// Building cell closest to a world position, not clamped to the grid
+		FGridPosition GetGridPosition(const FWorldPosition& inWorldPosition) const
+		{
+			const float grid_x = inWorldPosition.Y / mBuildingSize + mGridSize / 2;
+			const float grid_y = inWorldPosition.X / mBuildingSize + mGridSize / 2;
+			return FGridPosition(static_cast<int>(grid_x + (grid_x < 0.0f ? -0.5f : 0.5f)), static_cast<int>(grid_y + (grid_y < 0.0f ? -0.5f : 0.5f)));
+		}
+
+		FWorldPosition GetGridWorldPosition(const FGridPosition& inGridPosition, const EDirection inBuildingSide) const
+		{
+			FWorldPosition world_pos = GetGridWorldPosition(inGridPosition);
+			const FGridPosition dir_vector = GetDirectionVector(inBuildingSide);
+			world_pos.X += dir_vector.Y * mBuildingSize * 0.35f;
+			world_pos.Y += dir_vector.X * mBuildingSize * 0.35f;
+			return world_pos;
+		}
+	};
+}
@@ -0,0 +1,142 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "RouteDistanceField.h"
+#include <algorithm>
+#include "StreetTransitions.h"
+
+namespace RouteCore
+{
+	constexpr int FRouteDistanceField::WindowRadius;
+	constexpr int FRouteDistanceField::WindowSize;
+	constexpr int FRouteDistanceField::NumWindowStates;
+	constexpr std::uint8_t FRouteDistanceField::Unreached;
+
+	FRouteDistanceField::FRouteDistanceField()
+		: mStateDistances(NumWindowStates, Unreached)
+		, mStateParents(NumWindowStates, 0)
+		, mStateMoves(NumWindowStates, EDirection::FORWARD)
+		, mQueue(NumWindowStates, 0)
+		, mEndpointDistances(WindowSize * WindowSize * NumDirections, Unreached)
+	{
+	}
+
+	bool FRouteDistanceField::FindRoute(const FRouteState& inStartState, const int inMaxDistance, const int inGridSize, FRouteRandom& ioRandom, FDeliveryRoute& outRoute)
+	{
+		static constexpr EDirection move_directions[] = { EDirection::FORWARD, EDirection::LEFT, EDirection::RIGHT };
+
+		const int max_distance = std::max(1, std::min(inMaxDistance, static_cast<int>(FDeliveryRoute::MaxDirections)));
+		mWindowOrigin = inStartState.mGridPosition + FGridPosition(-WindowRadius, -WindowRadius);
+		std::fill(mStateDistances.begin(), mStateDistances.end(), Unreached);
+		std::fill(mEndpointDistances.begin(), mEndpointDistances.end(), Unreached);
+
+		const int start_state_i = GetStateIndex(inStartState.mGridPosition, inStartState.mFacingDirection, inStartState.mBuildingSide);
+		mStateDistances[start_state_i] = 0;
+		mEndpointDistances[GetEndpointIndex(inStartState.mGridPosition, inStartState.mBuildingSide)] = 0;
+		mQueue[0] = static_cast<std::uint16_t>(start_state_i);
+
+		// Every endpoint is seen once, the first time one of its states is reached, which is at its shortest distance.
+		// The farthest endpoints found so far are reservoir sampled, so picking one needs no retries.
+		int queue_begin = 0;
+		int queue_end = 1;
+		int picked_state_i = -1;
+		int picked_distance = 0;
+		int num_candidates = 0;
+		int num_rejected_moves = 0;
+		while (queue_begin < queue_end)
+		{
+			const int state_i = mQueue[queue_begin++];
+			const int distance = mStateDistances[state_i];
+			if (distance >= max_distance)
+				continue;
+
+			const FRouteState state = GetState(state_i);
+			const std::uint8_t boundary_class = GetBoundaryClass(state.mGridPosition.X, state.mGridPosition.Y, inGridSize);
+			const std::uint8_t legal_turns = GetLegalTurns(boundary_class, state.mFacingDirection, state.mBuildingSide);
+			for (const EDirection move_direction : move_directions)
+			{
+				if (!(legal_turns & ToMask(move_direction)))
+				{
+					++num_rejected_moves;
+					continue;
+				}
+
+				const FStreetMove& move = GetStreetMove(boundary_class, state.mFacingDirection, state.mBuildingSide, move_direction);
+				const FGridPosition new_cell = state.mGridPosition + FGridPosition(move.mStepX, move.mStepY);
+				if (!IsInWindow(new_cell))
+					continue;
+
+				const int new_state_i = GetStateIndex(new_cell, move.mFacingDirection, move.mBuildingSide);
+				if (mStateDistances[new_state_i] != Unreached)
+					continue;
+
+				mStateDistances[new_state_i] = static_cast<std::uint8_t>(distance + 1);
+				mStateParents[new_state_i] = static_cast<std::uint16_t>(state_i);
+				mStateMoves[new_state_i] = move_direction;
+				mQueue[queue_end++] = static_cast<std::uint16_t>(new_state_i);
+
+				std::uint8_t& endpoint_distance = mEndpointDistances[GetEndpointIndex(new_cell, move.mBuildingSide)];
+				if (endpoint_distance != Unreached)
+					continue;
+
+				endpoint_distance = static_cast<std::uint8_t>(distance + 1);
+				if (new_cell == inStartState.mGridPosition)
+					continue;
+
+				if (distance + 1 > picked_distance)
+				{
+					picked_distance = distance + 1;
+					num_candidates = 0;
+				}
+				if (ioRandom.NextInt(++num_candidates) == 0)
+					picked_state_i = new_state_i;
+			}
+		}
+		mNumVisitedStates = queue_end;
+		mNumRejectedMoves = num_rejected_moves;
+
+		if (picked_state_i < 0)
+			return false;
+
+		// Walk the parents back to the start to get the turns in order
+		outRoute.mNumDirections = picked_distance;
+		for (int state_i = picked_state_i, direction_i = picked_distance - 1; direction_i >= 0; state_i = mStateParents[state_i], --direction_i)
+			outRoute.mDirections[direction_i] = mStateMoves[state_i];
+		outRoute.mEndState = GetState(picked_state_i);
+		return true;
+	}
+
+	std::uint8_t FRouteDistanceField::GetEndpointDistance(const FGridPosition& inCell, const EDirection inBuildingSide) const
+	{
+		return IsInWindow(inCell) ? mEndpointDistances[GetEndpointIndex(inCell, inBuildingSide)] : Unreached;
+	}
+
+	bool FRouteDistanceField::IsInWindow(const FGridPosition& inCell) const
+	{
+		const int window_x = inCell.X - mWindowOrigin.X;
+		const int window_y = inCell.Y - mWindowOrigin.Y;
+		return window_x >= 0 && window_y >= 0 && window_x < WindowSize && window_y < WindowSize;
+	}
+
+	int FRouteDistanceField::GetStateIndex(const FGridPosition& inCell, const EDirection inFacingDirection, const EDirection inBuildingSide) const
+	{
+		const int window_cell_i = (inCell.Y - mWindowOrigin.Y) * WindowSize + (inCell.X - mWindowOrigin.X);
+		return (window_cell_i * NumDirections + ToIndex(inFacingDirection)) * NumDirections + ToIndex(inBuildingSide);
+	}
+
+	int FRouteDistanceField::GetEndpointIndex(const FGridPosition& inCell, const EDirection inBuildingSide) const
+	{
+		const int window_cell_i = (inCell.Y - mWindowOrigin.Y) * WindowSize + (inCell.X - mWindowOrigin.X);
+		return window_cell_i * NumDirections + ToIndex(inBuildingSide);
+	}
+
+	FRouteState FRouteDistanceField::GetState(const int inStateIndex) const
+	{
+		const int window_cell_i = inStateIndex / (NumDirections * NumDirections);
+
+		FRouteState state;
+		state.mBuildingSide = static_cast<EDirection>(inStateIndex % NumDirections);
+		state.mFacingDirection = static_cast<EDirection>((inStateIndex / NumDirections) % NumDirections);
+		state.mGridPosition = mWindowOrigin + FGridPosition(window_cell_i % WindowSize, window_cell_i / WindowSize);
+		return state;
+	}
+}
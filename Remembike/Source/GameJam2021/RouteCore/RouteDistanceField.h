@@ -0,0 +1,57 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "CityGrid.h"
+#include "RouteTypes.h"
+
+namespace RouteCore
+{
+	// Depth-limited breadth-first search over the street graph, from one (cell, facing, side) state to every
+	// (cell, side) delivery endpoint reachable in at most FDeliveryRoute::MaxDirections moves.
+	// The search only covers a window of MaxDirections cells around the start, so its cost does not depend
+	// on the grid size and its scratch buffers are allocated once, in the constructor.
+	class FRouteDistanceField
+	{
+	public:
+		static constexpr int WindowRadius = FDeliveryRoute::MaxDirections;
+		static constexpr int WindowSize = WindowRadius * 2 + 1;
+		static constexpr int NumWindowStates = WindowSize * WindowSize * NumDirections * NumDirections;
+		static constexpr std::uint8_t Unreached = 0xFF;
+
+		FRouteDistanceField();
+
+		// Searches up to inMaxDistance moves from inStartState and picks, uniformly, one of the endpoints whose
+		// shortest distance is exactly inMaxDistance, or the farthest ones when none is that far. Endpoints on
+		// the start cell are never picked. Returns false if there is no endpoint to pick at all.
+		bool FindRoute(const FRouteState& inStartState, const int inMaxDistance, const int inGridSize, FRouteRandom& ioRandom, FDeliveryRoute& outRoute);
+
+		// Shortest number of moves from the last searched start state to the given endpoint, Unreached if further than the search went
+		std::uint8_t GetEndpointDistance(const FGridPosition& inCell, const EDirection inBuildingSide) const;
+
+		// Counters of the last search, rejected moves are the turns the boundary does not allow
+		int GetNumVisitedStates() const { return mNumVisitedStates; }
+		int GetNumRejectedMoves() const { return mNumRejectedMoves; }
+
+	private:
+		bool IsInWindow(const FGridPosition& inCell) const;
+		int GetStateIndex(const FGridPosition& inCell, const EDirection inFacingDirection, const EDirection inBuildingSide) const;
+		int GetEndpointIndex(const FGridPosition& inCell, const EDirection inBuildingSide) const;
+		FRouteState GetState(const int inStateIndex) const;
+
+		FGridPosition mWindowOrigin;
+		int mNumVisitedStates = 0;
+		int mNumRejectedMoves = 0;
+
+		// Per window state: distance from the start, the state it was reached from and the move that reached it
+		std::vector<std::uint8_t> mStateDistances;
+		std::vector<std::uint16_t> mStateParents;
+		std::vector<EDirection> mStateMoves;
+		std::vector<std::uint16_t> mQueue;
+
+		// Per window endpoint (cell, side), shortest distance over every facing direction
+		std::vector<std::uint8_t> mEndpointDistances;
+	};
+}
@@ -0,0 +1,53 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "RouteGenerator.h"
+
+namespace RouteCore
+{
+	FRouteGenerator::FRouteGenerator(const int inGridSize, const std::uint32_t inSeed)
+		: mGridSize(inGridSize)
+		, mRandom(inSeed)
+	{
+	}
+
+	bool FRouteGenerator::GenerateRoute(const FRouteState& inStartState, const int inNumDirections, FDeliveryRoute& outRoute)
+	{
+		ROUTE_TRACE_EVENT(mTrace, ERouteEventType::RouteStart, inStartState, inStartState.mFacingDirection);
+		if (!mDistanceField.FindRoute(inStartState, inNumDirections, mGridSize, mRandom, outRoute))
+		{
+			outRoute.mNumDirections = 0;
+			outRoute.mEndState = inStartState;
+			ROUTE_TRACE_EVENT(mTrace, ERouteEventType::Fallback, inStartState, inStartState.mFacingDirection);
+			return false;
+		}
+
+#if REMEMBIKE_ROUTE_TRACE
+		if (mTrace)
+		{
+			FRouteState state = inStartState;
+			for (int direction_i = 0; direction_i < outRoute.mNumDirections; ++direction_i)
+			{
+				FRouteState next_state;
+				TryMove(state, outRoute.mDirections[direction_i], next_state);
+				state = next_state;
+				mTrace->Record(ERouteEventType::Move, state, outRoute.mDirections[direction_i]);
+			}
+		}
+#endif
+		ROUTE_TRACE_EVENT(mTrace, ERouteEventType::RouteEnd, outRoute.mEndState, outRoute.mEndState.mFacingDirection);
+		return true;
+	}
+
+	bool FRouteGenerator::TryMove(const FRouteState& inState, const EDirection inMoveDirection, FRouteState& outState) const
+	{
+		const std::uint8_t boundary_class = GetBoundaryClass(inState.mGridPosition.X, inState.mGridPosition.Y, mGridSize);
+		const FStreetMove& move = GetStreetMove(boundary_class, inState.mFacingDirection, inState.mBuildingSide, inMoveDirection);
+		if (!move.mIsLegal)
+			return false;
+
+		outState.mFacingDirection = move.mFacingDirection;
+		outState.mBuildingSide = move.mBuildingSide;
+		outState.mGridPosition = inState.mGridPosition + FGridPosition(move.mStepX, move.mStepY);
+		return true;
+	}
+}
@@ -0,0 +1,40 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "CityGrid.h"
+#include "RouteDistanceField.h"
+#include "RouteTrace.h"
+#include "RouteTypes.h"
+
+namespace RouteCore
+{
+	// Picks the next delivery among the endpoints whose shortest street distance matches the requested route length,
+	// and returns that shortest route. Never allocates after construction.
+	class FRouteGenerator
+	{
+	public:
+		FRouteGenerator(const int inGridSize = 6, const std::uint32_t inSeed = 1);
+
+		void SetGridSize(const int inGridSize) { mGridSize = inGridSize; }
+		int GetGridSize() const { return mGridSize; }
+		void SetSeed(const std::uint32_t inSeed) { mRandom.SetSeed(inSeed); }
+		void SetTrace(FRouteTrace* inTrace) { mTrace = inTrace; }
+
+		// The route is shorter than inNumDirections only when no endpoint is that far away. Returns false if no other
+		// building can be reached at all, in which case outRoute is empty and ends on inStartState.
+		bool GenerateRoute(const FRouteState& inStartState, const int inNumDirections, FDeliveryRoute& outRoute);
+
+		const FRouteDistanceField& GetDistanceField() const { return mDistanceField; }
+
+		bool TryMove(const FRouteState& inState, const EDirection inMoveDirection, FRouteState& outState) const;
+
+	private:
+		int mGridSize = 6;
+		FRouteRandom mRandom;
+		FRouteDistanceField mDistanceField;
+		FRouteTrace* mTrace = nullptr;
+	};
+}
@@ -0,0 +1,85 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "CityGrid.h"
+
+// Route tracing is compiled out when REMEMBIKE_ROUTE_TRACE is 0 (GameJam2021.Build.cs does that for Shipping)
+#ifndef REMEMBIKE_ROUTE_TRACE
+#define REMEMBIKE_ROUTE_TRACE 1
+#endif
+
+#if REMEMBIKE_ROUTE_TRACE
+#define ROUTE_TRACE_EVENT(inTrace, inType, inState, inTurn) do { if (inTrace) (inTrace)->Record((inType), (inState), (inTurn)); } while (0)
+#else
+#define ROUTE_TRACE_EVENT(inTrace, inType, inState, inTurn) do { } while (0)
+#endif
+
+namespace RouteCore
+{
+	enum class ERouteEventType : std::uint8_t
+	{
+		RouteStart,
+		Move,
+		RouteEnd,
+		Fallback
+	};
+
+	// One binary route event, the state is the one reached after the event
+	struct FRouteEvent
+	{
+		std::uint32_t mSequence = 0;
+		std::int16_t mX = 0;
+		std::int16_t mY = 0;
+		ERouteEventType mType = ERouteEventType::RouteStart;
+		EDirection mTurn = EDirection::FORWARD;
+		EDirection mFacingDirection = EDirection::FORWARD;
+		EDirection mBuildingSide = EDirection::FORWARD;
+	};
+
+	// Fixed-size ring buffer of the most recent route events. Recording is a plain struct copy,
+	// all formatting is left to whoever dumps it.
+	class FRouteTrace
+	{
+	public:
+		static constexpr int Capacity = 512;
+
+		template <typename TState>
+		void Record(const ERouteEventType inType, const TState& inState, const EDirection inTurn)
+		{
+			FRouteEvent& event = mEvents[mNumRecorded % Capacity];
+			event.mSequence = mNumRecorded++;
+			event.mX = static_cast<std::int16_t>(inState.mGridPosition.X);
+			event.mY = static_cast<std::int16_t>(inState.mGridPosition.Y);
+			event.mType = inType;
+			event.mTurn = inTurn;
+			event.mFacingDirection = inState.mFacingDirection;
+			event.mBuildingSide = inState.mBuildingSide;
+		}
+
+		void Reset() { mNumRecorded = 0; }
+
+		std::uint32_t GetNumRecorded() const { return mNumRecorded; }
+		int GetNum() const { return mNumRecorded < static_cast<std::uint32_t>(Capacity) ? static_cast<int>(mNumRecorded) : Capacity; }
+
+		// Events from oldest to newest
+		const FRouteEvent& GetEvent(const int inIndex) const
+		{
+			const std::uint32_t first_sequence = mNumRecorded - static_cast<std::uint32_t>(GetNum());
+			return mEvents[(first_sequence + static_cast<std::uint32_t>(inIndex)) % Capacity];
+		}
+
+	private:
+		std::array<FRouteEvent, Capacity> mEvents;
+		std::uint32_t mNumRecorded = 0;
+	};
+
+	constexpr const char* GetRouteEventTypeString(const ERouteEventType inType)
+	{
+		return inType == ERouteEventType::RouteStart ? "START" :
+			inType == ERouteEventType::Move ? "MOVE" :
+			inType == ERouteEventType::RouteEnd ? "END" : "FALLBACK";
+	}
+}
@@ -0,0 +1,49 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "CityGrid.h"
+
+namespace RouteCore
+{
+	struct FRouteState
+	{
+		EDirection mFacingDirection = EDirection::FORWARD;
+		EDirection mBuildingSide = EDirection::FORWARD;
+		FGridPosition mGridPosition;
+	};
+
+	// Fixed-capacity list of turns leading to the next delivery, plus the state it ends at
+	struct FDeliveryRoute
+	{
+		static constexpr int MaxDirections = 16;
+
+		std::array<EDirection, MaxDirections> mDirections;
+		int mNumDirections = 0;
+		FRouteState mEndState;
+	};
+
+	// Small xorshift generator, so routes do not depend on the global rand() state
+	class FRouteRandom
+	{
+	public:
+		explicit FRouteRandom(const std::uint32_t inSeed = 1) { SetSeed(inSeed); }
+
+		void SetSeed(const std::uint32_t inSeed) { mState = (inSeed != 0 ? inSeed : 0x9E3779B9u); }
+
+		std::uint32_t Next()
+		{
+			mState ^= mState << 13;
+			mState ^= mState >> 17;
+			mState ^= mState << 5;
+			return mState;
+		}
+
+		int NextInt(const int inMax) { return static_cast<int>(Next() % static_cast<std::uint32_t>(inMax)); }
+
+	private:
+		std::uint32_t mState = 1;
+	};
+}
@@ -0,0 +1,279 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetPathfinder.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include "StreetTransitions.h"
+
+namespace RouteCore
+{
+	constexpr int FStreetGraph::NumMoves;
+	constexpr std::int32_t FStreetGraph::NoState;
+	constexpr std::uint16_t FStreetFlowField::Unreached;
+
+	namespace
+	{
+		constexpr EDirection MoveDirections[FStreetGraph::NumMoves] = { EDirection::FORWARD, EDirection::LEFT, EDirection::RIGHT };
+
+		bool IsGoal(const FRouteState& inState, const FGridPosition& inGoalCell, const EDirection inGoalSide)
+		{
+			return inState.mGridPosition == inGoalCell && inState.mBuildingSide == inGoalSide;
+		}
+	}
+
+	FStreetGraph::FStreetGraph(const int inGridSize)
+		: mGridSize(std::max(inGridSize, 1))
+	{
+		const int num_states = GetNumStates();
+		mNextStates.assign(num_states * NumMoves, NoState);
+		mPredecessorOffsets.assign(num_states + 1, 0);
+
+		for (int state_i = 0; state_i < num_states; ++state_i)
+		{
+			const FRouteState state = GetState(state_i);
+			const std::uint8_t boundary_class = GetBoundaryClass(state.mGridPosition.X, state.mGridPosition.Y, mGridSize);
+			for (int move_i = 0; move_i < NumMoves; ++move_i)
+			{
+				const FStreetMove& move = GetStreetMove(boundary_class, state.mFacingDirection, state.mBuildingSide, MoveDirections[move_i]);
+				if (!move.mIsLegal)
+					continue;
+
+				FRouteState next_state;
+				next_state.mFacingDirection = move.mFacingDirection;
+				next_state.mBuildingSide = move.mBuildingSide;
+				next_state.mGridPosition = state.mGridPosition + FGridPosition(move.mStepX, move.mStepY);
+				if (!IsInside(next_state.mGridPosition))
+					continue;
+
+				const int next_state_i = GetStateIndex(next_state);
+				mNextStates[state_i * NumMoves + move_i] = next_state_i;
+				++mPredecessorOffsets[next_state_i + 1];
+			}
+		}
+
+		// Reverse edges in compressed rows, counted above and filled here
+		for (int state_i = 0; state_i < num_states; ++state_i)
+			mPredecessorOffsets[state_i + 1] += mPredecessorOffsets[state_i];
+
+		mPredecessorStates.resize(mPredecessorOffsets[num_states]);
+		mPredecessorMoves.resize(mPredecessorOffsets[num_states]);
+		std::vector<std::int32_t> fill_offsets(mPredecessorOffsets.begin(), mPredecessorOffsets.end() - 1);
+		for (int state_i = 0; state_i < num_states; ++state_i)
+		{
+			for (int move_i = 0; move_i < NumMoves; ++move_i)
+			{
+				const std::int32_t next_state_i = mNextStates[state_i * NumMoves + move_i];
+				if (next_state_i == NoState)
+					continue;
+
+				const int predecessor = fill_offsets[next_state_i]++;
+				mPredecessorStates[predecessor] = state_i;
+				mPredecessorMoves[predecessor] = static_cast<std::uint8_t>(move_i);
+			}
+		}
+	}
+
+	int FStreetGraph::GetStateIndex(const FRouteState& inState) const
+	{
+		const int cell_i = inState.mGridPosition.Y * mGridSize + inState.mGridPosition.X;
+		return (cell_i * NumDirections + ToIndex(inState.mFacingDirection)) * NumDirections + ToIndex(inState.mBuildingSide);
+	}
+
+	FRouteState FStreetGraph::GetState(const int inStateIndex) const
+	{
+		const int cell_i = inStateIndex / (NumDirections * NumDirections);
+
+		FRouteState state;
+		state.mBuildingSide = static_cast<EDirection>(inStateIndex % NumDirections);
+		state.mFacingDirection = static_cast<EDirection>((inStateIndex / NumDirections) % NumDirections);
+		state.mGridPosition = FGridPosition(cell_i % mGridSize, cell_i / mGridSize);
+		return state;
+	}
+
+	bool FStreetGraph::IsInside(const FGridPosition& inCell) const
+	{
+		return inCell.X >= 0 && inCell.Y >= 0 && inCell.X < mGridSize && inCell.Y < mGridSize;
+	}
+
+	EDirection FStreetGraph::GetMoveDirection(const int inMove)
+	{
+		return MoveDirections[inMove];
+	}
+
+	int FStreetGraph::GetMove(const EDirection inDirection)
+	{
+		return static_cast<int>(std::find(std::begin(MoveDirections), std::end(MoveDirections), inDirection) - std::begin(MoveDirections));
+	}
+
+	std::size_t FStreetGraph::GetAllocatedBytes() const
+	{
+		return (mNextStates.capacity() + mPredecessorOffsets.capacity() + mPredecessorStates.capacity()) * sizeof(std::int32_t) + mPredecessorMoves.capacity();
+	}
+
+	void FStreetFlowField::Build(const FStreetGraph& inGraph, const FGridPosition& inGoalCell, const EDirection inGoalSide)
+	{
+		const int num_states = inGraph.GetNumStates();
+		mGoalCell = inGoalCell;
+		mGoalSide = inGoalSide;
+		mDistances.assign(num_states, Unreached);
+		mMoves.assign(num_states, 0);
+		if (!inGraph.IsInside(inGoalCell))
+			return;
+
+		// Not kept with the field, cached fields only pay for the distances and moves
+		std::vector<std::int32_t> queue(num_states);
+
+		// The goal is the building side, whatever the facing direction the bike arrives with
+		int queue_begin = 0;
+		int queue_end = 0;
+		for (int facing_i = 0; facing_i < NumDirections; ++facing_i)
+		{
+			FRouteState goal_state;
+			goal_state.mGridPosition = inGoalCell;
+			goal_state.mFacingDirection = static_cast<EDirection>(facing_i);
+			goal_state.mBuildingSide = inGoalSide;
+			const int goal_state_i = inGraph.GetStateIndex(goal_state);
+			mDistances[goal_state_i] = 0;
+			queue[queue_end++] = goal_state_i;
+		}
+
+		while (queue_begin < queue_end)
+		{
+			const int state_i = queue[queue_begin++];
+			const std::uint16_t distance = mDistances[state_i];
+			for (int predecessor = inGraph.GetFirstPredecessor(state_i); predecessor < inGraph.GetFirstPredecessor(state_i + 1); ++predecessor)
+			{
+				const int predecessor_state_i = inGraph.GetPredecessorState(predecessor);
+				if (mDistances[predecessor_state_i] != Unreached)
+					continue;
+
+				mDistances[predecessor_state_i] = static_cast<std::uint16_t>(distance + 1);
+				mMoves[predecessor_state_i] = static_cast<std::uint8_t>(inGraph.GetPredecessorMove(predecessor));
+				queue[queue_end++] = predecessor_state_i;
+			}
+		}
+	}
+
+	bool FStreetFlowField::GetPath(const FStreetGraph& inGraph, const FRouteState& inStartState, FStreetPath& outPath) const
+	{
+		outPath.mDirections.clear();
+		outPath.mEndState = inStartState;
+		if (!inGraph.IsInside(inStartState.mGridPosition) || mDistances.empty())
+			return false;
+
+		int state_i = inGraph.GetStateIndex(inStartState);
+		if (mDistances[state_i] == Unreached)
+			return false;
+
+		while (mDistances[state_i] != 0)
+		{
+			outPath.mDirections.push_back(FStreetGraph::GetMoveDirection(mMoves[state_i]));
+			state_i = inGraph.GetNextState(state_i, mMoves[state_i]);
+		}
+		outPath.mEndState = inGraph.GetState(state_i);
+		return true;
+	}
+
+	FStreetPathfinder::FStreetPathfinder(const FStreetGraph& inGraph)
+		: mGraph(inGraph)
+		, mStamps(inGraph.GetNumStates(), 0)
+		, mCosts(inGraph.GetNumStates(), 0)
+		, mParents(inGraph.GetNumStates(), FStreetGraph::NoState)
+		, mParentMoves(inGraph.GetNumStates(), 0)
+	{
+		mOpen.reserve(inGraph.GetNumStates());
+	}
+
+	bool FStreetPathfinder::FindPath(const FRouteState& inStartState, const FGridPosition& inGoalCell, const EDirection inGoalSide, FStreetPath& outPath)
+	{
+		outPath.mDirections.clear();
+		outPath.mEndState = inStartState;
+		mNumExpandedStates = 0;
+		if (!mGraph.IsInside(inStartState.mGridPosition) || !mGraph.IsInside(inGoalCell))
+			return false;
+
+		// A new stamp invalidates every cost at once, the stamps are only cleared when it wraps around
+		if (++mSearch == 0)
+		{
+			std::fill(mStamps.begin(), mStamps.end(), 0);
+			mSearch = 1;
+		}
+
+		auto get_heuristic = [&inGoalCell](const FGridPosition& inCell)
+		{
+			return std::max(std::abs(inCell.X - inGoalCell.X), std::abs(inCell.Y - inGoalCell.Y));
+		};
+
+		// Open entries pack f, then the inverted cost so ties go to the deeper state, then the state. Entries whose cost
+		// is stale are skipped when popped instead of being updated in the heap.
+		auto make_open_entry = [](const int inF, const int inCost, const int inStateIndex)
+		{
+			return (static_cast<std::uint64_t>(inF) << 48) | (static_cast<std::uint64_t>(0xFFFF - inCost) << 32) | static_cast<std::uint32_t>(inStateIndex);
+		};
+
+		const int start_state_i = mGraph.GetStateIndex(inStartState);
+		mStamps[start_state_i] = mSearch;
+		mCosts[start_state_i] = 0;
+		mParents[start_state_i] = FStreetGraph::NoState;
+		mOpen.clear();
+		mOpen.push_back(make_open_entry(get_heuristic(inStartState.mGridPosition), 0, start_state_i));
+
+		int goal_state_i = FStreetGraph::NoState;
+		while (!mOpen.empty())
+		{
+			std::pop_heap(mOpen.begin(), mOpen.end(), std::greater<std::uint64_t>());
+			const std::uint64_t entry = mOpen.back();
+			mOpen.pop_back();
+
+			const int state_i = static_cast<int>(entry & 0xFFFFFFFFu);
+			const int cost = 0xFFFF - static_cast<int>((entry >> 32) & 0xFFFF);
+			if (cost != mCosts[state_i])
+				continue;
+
+			++mNumExpandedStates;
+			const FRouteState state = mGraph.GetState(state_i);
+			if (IsGoal(state, inGoalCell, inGoalSide))
+			{
+				goal_state_i = state_i;
+				break;
+			}
+
+			for (int move_i = 0; move_i < FStreetGraph::NumMoves; ++move_i)
+			{
+				const std::int32_t next_state_i = mGraph.GetNextState(state_i, move_i);
+				if (next_state_i == FStreetGraph::NoState)
+					continue;
+
+				const int next_cost = cost + 1;
+				if (mStamps[next_state_i] == mSearch && mCosts[next_state_i] <= next_cost)
+					continue;
+
+				mStamps[next_state_i] = mSearch;
+				mCosts[next_state_i] = static_cast<std::uint16_t>(next_cost);
+				mParents[next_state_i] = state_i;
+				mParentMoves[next_state_i] = static_cast<std::uint8_t>(move_i);
+
+				mOpen.push_back(make_open_entry(next_cost + get_heuristic(mGraph.GetState(next_state_i).mGridPosition), next_cost, next_state_i));
+				std::push_heap(mOpen.begin(), mOpen.end(), std::greater<std::uint64_t>());
+			}
+		}
+
+		if (goal_state_i == FStreetGraph::NoState)
+			return false;
+
+		// Walk the parents back to the start to get the turns in order
+		outPath.mDirections.resize(mCosts[goal_state_i]);
+		for (int state_i = goal_state_i, direction_i = mCosts[goal_state_i] - 1; direction_i >= 0; state_i = mParents[state_i], --direction_i)
+			outPath.mDirections[direction_i] = FStreetGraph::GetMoveDirection(mParentMoves[state_i]);
+		outPath.mEndState = mGraph.GetState(goal_state_i);
+		return true;
+	}
+
+	std::size_t FStreetPathfinder::GetAllocatedBytes() const
+	{
+		return mStamps.capacity() * sizeof(std::uint32_t) + mCosts.capacity() * sizeof(std::uint16_t) + mParents.capacity() * sizeof(std::int32_t) +
+			mParentMoves.capacity() + mOpen.capacity() * sizeof(std::uint64_t);
+	}
+}
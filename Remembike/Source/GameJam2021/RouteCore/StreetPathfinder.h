@@ -0,0 +1,108 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "CityGrid.h"
+#include "RouteTypes.h"
+
+namespace RouteCore
+{
+	// Moves along the streets, from a (cell, facing, side) state to the building side (cell, side) it ends next to
+	struct FStreetPath
+	{
+		std::vector<EDirection> mDirections;
+		FRouteState mEndState;
+	};
+
+	// Every (cell, facing, side) state of a whole grid with the state each move leads to, and the reverse edges the
+	// flow fields are built from. Immutable once built, so one graph can be read by any number of threads.
+	class FStreetGraph
+	{
+	public:
+		// The turns a route can take, a U-turn is never one of them
+		static constexpr int NumMoves = 3;
+		static constexpr std::int32_t NoState = -1;
+
+		explicit FStreetGraph(const int inGridSize = 6);
+
+		int GetGridSize() const { return mGridSize; }
+		int GetNumStates() const { return mGridSize * mGridSize * NumDirections * NumDirections; }
+		int GetStateIndex(const FRouteState& inState) const;
+		FRouteState GetState(const int inStateIndex) const;
+		bool IsInside(const FGridPosition& inCell) const;
+
+		static EDirection GetMoveDirection(const int inMove);
+		static int GetMove(const EDirection inDirection); // NumMoves for BACK
+		std::int32_t GetNextState(const int inStateIndex, const int inMove) const { return mNextStates[inStateIndex * NumMoves + inMove]; }
+
+		// Predecessors of a state are [GetFirstPredecessor(state), GetFirstPredecessor(state + 1))
+		int GetFirstPredecessor(const int inStateIndex) const { return mPredecessorOffsets[inStateIndex]; }
+		std::int32_t GetPredecessorState(const int inPredecessor) const { return mPredecessorStates[inPredecessor]; }
+		int GetPredecessorMove(const int inPredecessor) const { return mPredecessorMoves[inPredecessor]; }
+
+		std::size_t GetAllocatedBytes() const;
+
+	private:
+		int mGridSize = 6;
+		std::vector<std::int32_t> mNextStates; // [state][move], NoState for the turns the boundary does not allow
+		std::vector<std::int32_t> mPredecessorOffsets;
+		std::vector<std::int32_t> mPredecessorStates;
+		std::vector<std::uint8_t> mPredecessorMoves;
+	};
+
+	// Shortest number of moves from every state of a graph to one building side, and the move that starts it.
+	// Built once per target with a breadth-first search over the reverse edges, after which the path of any agent
+	// heading there is a walk down the field.
+	class FStreetFlowField
+	{
+	public:
+		static constexpr std::uint16_t Unreached = 0xFFFF;
+
+		void Build(const FStreetGraph& inGraph, const FGridPosition& inGoalCell, const EDirection inGoalSide);
+
+		const FGridPosition& GetGoalCell() const { return mGoalCell; }
+		EDirection GetGoalSide() const { return mGoalSide; }
+		std::uint16_t GetDistance(const int inStateIndex) const { return mDistances[inStateIndex]; }
+
+		// Returns false if the goal cannot be reached from inStartState, outPath is then empty
+		bool GetPath(const FStreetGraph& inGraph, const FRouteState& inStartState, FStreetPath& outPath) const;
+
+		std::size_t GetAllocatedBytes() const { return mDistances.capacity() * sizeof(std::uint16_t) + mMoves.capacity(); }
+
+	private:
+		FGridPosition mGoalCell;
+		EDirection mGoalSide = EDirection::FORWARD;
+		std::vector<std::uint16_t> mDistances;
+		std::vector<std::uint8_t> mMoves;
+	};
+
+	// A* from a state to a building side, with the largest of the cell distances on each axis as heuristic, which
+	// never overestimates since no move steps more than one cell per axis. The scratch buffers are sized for the
+	// whole graph once, in the constructor, so use one pathfinder per thread.
+	class FStreetPathfinder
+	{
+	public:
+		explicit FStreetPathfinder(const FStreetGraph& inGraph);
+
+		// Returns false if the goal cannot be reached from inStartState, outPath is then empty
+		bool FindPath(const FRouteState& inStartState, const FGridPosition& inGoalCell, const EDirection inGoalSide, FStreetPath& outPath);
+
+		// States expanded by the last search
+		int GetNumExpandedStates() const { return mNumExpandedStates; }
+		std::size_t GetAllocatedBytes() const;
+
+	private:
+		const FStreetGraph& mGraph;
+		std::uint32_t mSearch = 0;
+		int mNumExpandedStates = 0;
+
+		// Per state, costs and parents are only valid when its stamp is the current search
+		std::vector<std::uint32_t> mStamps;
+		std::vector<std::uint16_t> mCosts;
+		std::vector<std::int32_t> mParents;
+		std::vector<std::uint8_t> mParentMoves;
+		std::vector<std::uint64_t> mOpen;
+	};
+}
@@ -0,0 +1,188 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+
+// Street movement rules of the city grid, kept free of engine types so they can be evaluated at compile time.
+//
+// The bike is always on the street next to one side of a building, described by the building grid position,
+// the side of the building and the direction it is facing. A turn moves it to the next street segment.
+namespace RouteCore
+{
+	enum class EDirection : std::uint8_t
+	{
+		BACK,
+		FORWARD,
+		LEFT,
+		RIGHT
+	};
+
+	static constexpr int NumDirections = 4;
+
+	constexpr int ToIndex(const EDirection inDirection) { return static_cast<int>(inDirection); }
+	constexpr std::uint8_t ToMask(const EDirection inDirection) { return static_cast<std::uint8_t>(1u << ToIndex(inDirection)); }
+
+	struct FStreetTransition
+	{
+		EDirection mFacingDirection;
+		EDirection mBuildingSide;
+		std::int8_t mStepX;
+		std::int8_t mStepY;
+	};
+
+	// New facing direction, new building side and grid step, indexed by [facing][building side][turn].
+	// Grid steps are in building units, X going RIGHT and Y going FORWARD.
+	static constexpr FStreetTransition StreetTransitions[NumDirections][NumDirections][NumDirections] =
+	{
+		// Facing BACK
+		{
+			{ { EDirection::FORWARD, EDirection::BACK, 0, 1 }, { EDirection::BACK, EDirection::BACK, 0, -1 }, { EDirection::RIGHT, EDirection::FORWARD, 0, -1 }, { EDirection::LEFT, EDirection::FORWARD, -1, -1 } }, // Side BACK
+			{ { EDirection::FORWARD, EDirection::FORWARD, 0, 1 }, { EDirection::BACK, EDirection::FORWARD, 0, -1 }, { EDirection::RIGHT, EDirection::FORWARD, 0, -1 }, { EDirection::LEFT, EDirection::FORWARD, -1, -1 } }, // Side FORWARD
+			{ { EDirection::FORWARD, EDirection::LEFT, 0, 1 }, { EDirection::BACK, EDirection::LEFT, 0, -1 }, { EDirection::RIGHT, EDirection::FORWARD, 0, -1 }, { EDirection::LEFT, EDirection::FORWARD, -1, -1 } }, // Side LEFT
+			{ { EDirection::FORWARD, EDirection::RIGHT, 0, 1 }, { EDirection::BACK, EDirection::RIGHT, 0, -1 }, { EDirection::RIGHT, EDirection::FORWARD, 1, -1 }, { EDirection::LEFT, EDirection::FORWARD, 0, -1 } }, // Side RIGHT
+		},
+		// Facing FORWARD
+		{
+			{ { EDirection::BACK, EDirection::BACK, 0, -1 }, { EDirection::FORWARD, EDirection::BACK, 0, 1 }, { EDirection::LEFT, EDirection::FORWARD, -1, 0 }, { EDirection::RIGHT, EDirection::FORWARD, 0, 0 } }, // Side BACK
+			{ { EDirection::BACK, EDirection::FORWARD, 0, -1 }, { EDirection::FORWARD, EDirection::FORWARD, 0, 1 }, { EDirection::LEFT, EDirection::FORWARD, -1, 0 }, { EDirection::RIGHT, EDirection::FORWARD, 0, 0 } }, // Side FORWARD
+			{ { EDirection::BACK, EDirection::LEFT, 0, -1 }, { EDirection::FORWARD, EDirection::LEFT, 0, 1 }, { EDirection::LEFT, EDirection::FORWARD, -1, 0 }, { EDirection::RIGHT, EDirection::FORWARD, 0, 0 } }, // Side LEFT
+			{ { EDirection::BACK, EDirection::RIGHT, 0, -1 }, { EDirection::FORWARD, EDirection::RIGHT, 0, 1 }, { EDirection::LEFT, EDirection::FORWARD, 0, 0 }, { EDirection::RIGHT, EDirection::FORWARD, 1, 0 } }, // Side RIGHT
+		},
+		// Facing LEFT
+		{
+			{ { EDirection::RIGHT, EDirection::BACK, 1, 0 }, { EDirection::LEFT, EDirection::BACK, -1, 0 }, { EDirection::BACK, EDirection::RIGHT, -1, -1 }, { EDirection::FORWARD, EDirection::RIGHT, -1, 0 } }, // Side BACK
+			{ { EDirection::RIGHT, EDirection::FORWARD, 1, 0 }, { EDirection::LEFT, EDirection::FORWARD, -1, 0 }, { EDirection::BACK, EDirection::RIGHT, -1, 0 }, { EDirection::FORWARD, EDirection::RIGHT, -1, 1 } }, // Side FORWARD
+			{ { EDirection::RIGHT, EDirection::LEFT, 1, 0 }, { EDirection::LEFT, EDirection::LEFT, -1, 0 }, { EDirection::BACK, EDirection::RIGHT, -1, -1 }, { EDirection::FORWARD, EDirection::RIGHT, -1, 0 } }, // Side LEFT
+			{ { EDirection::RIGHT, EDirection::RIGHT, 1, 0 }, { EDirection::LEFT, EDirection::RIGHT, -1, 0 }, { EDirection::BACK, EDirection::RIGHT, -1, -1 }, { EDirection::FORWARD, EDirection::RIGHT, -1, 0 } }, // Side RIGHT
+		},
+		// Facing RIGHT
+		{
+			{ { EDirection::LEFT, EDirection::BACK, -1, 0 }, { EDirection::RIGHT, EDirection::BACK, 1, 0 }, { EDirection::FORWARD, EDirection::RIGHT, 0, 0 }, { EDirection::BACK, EDirection::RIGHT, 0, -1 } }, // Side BACK
+			{ { EDirection::LEFT, EDirection::FORWARD, -1, 0 }, { EDirection::RIGHT, EDirection::FORWARD, 1, 0 }, { EDirection::FORWARD, EDirection::RIGHT, 0, 1 }, { EDirection::BACK, EDirection::RIGHT, 0, 0 } }, // Side FORWARD
+			{ { EDirection::LEFT, EDirection::LEFT, -1, 0 }, { EDirection::RIGHT, EDirection::LEFT, 1, 0 }, { EDirection::FORWARD, EDirection::RIGHT, 0, 0 }, { EDirection::BACK, EDirection::RIGHT, 0, -1 } }, // Side LEFT
+			{ { EDirection::LEFT, EDirection::RIGHT, -1, 0 }, { EDirection::RIGHT, EDirection::RIGHT, 1, 0 }, { EDirection::FORWARD, EDirection::RIGHT, 0, 0 }, { EDirection::BACK, EDirection::RIGHT, 0, -1 } }, // Side RIGHT
+		},
+	};
+
+	// Boundary class of a grid cell, one bit per grid edge the cell touches
+	enum EBoundaryBits : std::uint8_t
+	{
+		BoundaryMinX = 1 << 0,
+		BoundaryMinY = 1 << 1,
+		BoundaryMaxX = 1 << 2,
+		BoundaryMaxY = 1 << 3
+	};
+
+	static constexpr int NumBoundaryClasses = 16;
+
+	constexpr std::uint8_t GetBoundaryClass(const int inX, const int inY, const int inGridSize)
+	{
+		return static_cast<std::uint8_t>((inX <= 0 ? BoundaryMinX : 0) | (inY <= 0 ? BoundaryMinY : 0) |
+			(inX >= inGridSize - 1 ? BoundaryMaxX : 0) | (inY >= inGridSize - 1 ? BoundaryMaxY : 0));
+	}
+
+	// Turns that would take the bike outside of the city on each grid edge, as turn masks indexed by [edge][facing]
+	static constexpr std::uint8_t BoundaryForbiddenTurns[4][NumDirections] =
+	{
+		// MinX: facing BACK, FORWARD, LEFT, RIGHT
+		{ ToMask(EDirection::RIGHT), ToMask(EDirection::LEFT), ToMask(EDirection::FORWARD), ToMask(EDirection::BACK) },
+		// MinY
+		{ ToMask(EDirection::FORWARD), ToMask(EDirection::BACK), ToMask(EDirection::LEFT), ToMask(EDirection::RIGHT) },
+		// MaxX
+		{ ToMask(EDirection::LEFT), ToMask(EDirection::RIGHT), ToMask(EDirection::BACK), ToMask(EDirection::FORWARD) },
+		// MaxY
+		{ ToMask(EDirection::BACK), ToMask(EDirection::FORWARD), ToMask(EDirection::RIGHT), ToMask(EDirection::LEFT) },
+	};
+
+	// A street transition resolved for a boundary class: the streets along the MinX/MinY edges have no building
+	// on their outer side, so they are stored as the LEFT/BACK side of the first row/column of buildings.
+	struct FStreetMove
+	{
+		EDirection mFacingDirection = EDirection::FORWARD;
+		EDirection mBuildingSide = EDirection::FORWARD;
+		std::int8_t mStepX = 0;
+		std::int8_t mStepY = 0;
+		bool mIsLegal = false;
+	};
+
+	struct FStreetMoveTable
+	{
+		FStreetMove mMoves[NumBoundaryClasses][NumDirections][NumDirections][NumDirections];
+		std::uint8_t mLegalTurns[NumBoundaryClasses][NumDirections][NumDirections];
+	};
+
+	constexpr FStreetMove ResolveStreetMove(const std::uint8_t inBoundaryClass, const EDirection inFacingDirection, const EDirection inBuildingSide, const EDirection inTurn)
+	{
+		FStreetMove move;
+		for (int edge_i = 0; edge_i < 4; ++edge_i)
+		{
+			if ((inBoundaryClass & (1 << edge_i)) && (BoundaryForbiddenTurns[edge_i][ToIndex(inFacingDirection)] & ToMask(inTurn)))
+				return move;
+		}
+
+		const FStreetTransition& transition = StreetTransitions[ToIndex(inFacingDirection)][ToIndex(inBuildingSide)][ToIndex(inTurn)];
+		move.mFacingDirection = transition.mFacingDirection;
+		move.mBuildingSide = transition.mBuildingSide;
+		move.mStepX = transition.mStepX;
+		move.mStepY = transition.mStepY;
+
+		const bool leaves_min_x = (inBoundaryClass & BoundaryMinX) && move.mStepX < 0;
+		const bool leaves_min_y = (inBoundaryClass & BoundaryMinY) && move.mStepY < 0;
+		const bool leaves_max_x = (inBoundaryClass & BoundaryMaxX) && move.mStepX > 0;
+		const bool leaves_max_y = (inBoundaryClass & BoundaryMaxY) && move.mStepY > 0;
+		if ((leaves_min_x && leaves_min_y) || leaves_max_x || leaves_max_y)
+			return move;
+
+		if (leaves_min_x)
+		{
+			move.mStepX = 0;
+			move.mBuildingSide = EDirection::LEFT;
+		}
+		else if (leaves_min_y)
+		{
+			move.mStepY = 0;
+			move.mBuildingSide = EDirection::BACK;
+		}
+
+		move.mIsLegal = true;
+		return move;
+	}
+
+	constexpr FStreetMoveTable BuildStreetMoveTable()
+	{
+		FStreetMoveTable table = {};
+		for (int boundary_class = 0; boundary_class < NumBoundaryClasses; ++boundary_class)
+		{
+			for (int facing_i = 0; facing_i < NumDirections; ++facing_i)
+			{
+				for (int side_i = 0; side_i < NumDirections; ++side_i)
+				{
+					table.mLegalTurns[boundary_class][facing_i][side_i] = 0;
+					for (int turn_i = 0; turn_i < NumDirections; ++turn_i)
+					{
+						const FStreetMove move = ResolveStreetMove(static_cast<std::uint8_t>(boundary_class),
+							static_cast<EDirection>(facing_i), static_cast<EDirection>(side_i), static_cast<EDirection>(turn_i));
+						table.mMoves[boundary_class][facing_i][side_i][turn_i] = move;
+						if (move.mIsLegal)
+							table.mLegalTurns[boundary_class][facing_i][side_i] |= ToMask(static_cast<EDirection>(turn_i));
+					}
+				}
+			}
+		}
+		return table;
+	}
+
+	// Every street move, already resolved against the grid edges, indexed by [boundary class][facing][building side][turn]
+	static constexpr FStreetMoveTable StreetMoveTable = BuildStreetMoveTable();
+
+	constexpr const FStreetMove& GetStreetMove(const std::uint8_t inBoundaryClass, const EDirection inFacingDirection, const EDirection inBuildingSide, const EDirection inTurn)
+	{
+		return StreetMoveTable.mMoves[inBoundaryClass][ToIndex(inFacingDirection)][ToIndex(inBuildingSide)][ToIndex(inTurn)];
+	}
+
+	constexpr std::uint8_t GetLegalTurns(const std::uint8_t inBoundaryClass, const EDirection inFacingDirection, const EDirection inBuildingSide)
+	{
+		return StreetMoveTable.mLegalTurns[inBoundaryClass][ToIndex(inFacingDirection)][ToIndex(inBuildingSide)];
+	}
+}
@@ -0,0 +1,185 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StreetTransitions.h"
+
+// Compile-time check of the street move tables against the nested branch logic GenerateNextDelivery used to have.
+// Nothing in here is compiled into the game, a mismatch simply fails the build.
+namespace RouteCore
+{
+	namespace
+	{
+		struct FBranchMove
+		{
+			EDirection mFacingDirection = EDirection::FORWARD;
+			EDirection mBuildingSide = EDirection::FORWARD;
+			int mX = 0;
+			int mY = 0;
+			bool mIsLegal = false;
+		};
+
+		constexpr EDirection BranchOppositeDirection(const EDirection inDirection)
+		{
+			return inDirection == EDirection::FORWARD ? EDirection::BACK :
+				inDirection == EDirection::BACK ? EDirection::FORWARD :
+				inDirection == EDirection::LEFT ? EDirection::RIGHT : EDirection::LEFT;
+		}
+
+		constexpr int BranchDirectionX(const EDirection inDirection)
+		{
+			return inDirection == EDirection::LEFT ? -1 : inDirection == EDirection::RIGHT ? 1 : 0;
+		}
+
+		constexpr int BranchDirectionY(const EDirection inDirection)
+		{
+			return inDirection == EDirection::BACK ? -1 : inDirection == EDirection::FORWARD ? 1 : 0;
+		}
+
+		constexpr FBranchMove BranchMove(const int inGridSize, const int inX, const int inY, const EDirection current_facing_dir, const EDirection current_building_side, const EDirection next_move_direction)
+		{
+			FBranchMove move;
+
+			// Avoid taking a direction that would go outside
+			if (inX <= 0)
+			{
+				if (current_facing_dir == EDirection::LEFT && next_move_direction == EDirection::FORWARD) return move;
+				if (current_facing_dir == EDirection::RIGHT && next_move_direction == EDirection::BACK) return move;
+				if (current_facing_dir == EDirection::FORWARD && next_move_direction == EDirection::LEFT) return move;
+				if (current_facing_dir == EDirection::BACK && next_move_direction == EDirection::RIGHT) return move;
+			}
+			if (inY <= 0)
+			{
+				if (current_facing_dir == EDirection::FORWARD && next_move_direction == EDirection::BACK) return move;
+				if (current_facing_dir == EDirection::BACK && next_move_direction == EDirection::FORWARD) return move;
+				if (current_facing_dir == EDirection::RIGHT && next_move_direction == EDirection::RIGHT) return move;
+				if (current_facing_dir == EDirection::LEFT && next_move_direction == EDirection::LEFT) return move;
+			}
+			if (inX >= inGridSize - 1)
+			{
+				if (current_facing_dir == EDirection::RIGHT && next_move_direction == EDirection::FORWARD) return move;
+				if (current_facing_dir == EDirection::LEFT && next_move_direction == EDirection::BACK) return move;
+				if (current_facing_dir == EDirection::FORWARD && next_move_direction == EDirection::RIGHT) return move;
+				if (current_facing_dir == EDirection::BACK && next_move_direction == EDirection::LEFT) return move;
+			}
+			if (inY >= inGridSize - 1)
+			{
+				if (current_facing_dir == EDirection::FORWARD && next_move_direction == EDirection::FORWARD) return move;
+				if (current_facing_dir == EDirection::BACK && next_move_direction == EDirection::BACK) return move;
+				if (current_facing_dir == EDirection::RIGHT && next_move_direction == EDirection::LEFT) return move;
+				if (current_facing_dir == EDirection::LEFT && next_move_direction == EDirection::RIGHT) return move;
+			}
+
+			EDirection new_facing_dir = current_facing_dir;
+			EDirection new_building_side = current_building_side;
+			int new_x = inX;
+			int new_y = inY;
+			if (next_move_direction == EDirection::FORWARD)
+			{
+				new_x += BranchDirectionX(current_facing_dir);
+				new_y += BranchDirectionY(current_facing_dir);
+			}
+			else if (next_move_direction == EDirection::BACK)
+			{
+				new_facing_dir = BranchOppositeDirection(current_facing_dir);
+				new_x -= BranchDirectionX(current_facing_dir);
+				new_y -= BranchDirectionY(current_facing_dir);
+			}
+			else if (next_move_direction == EDirection::LEFT)
+			{
+				if (current_facing_dir == EDirection::FORWARD) new_facing_dir = EDirection::LEFT;
+				else if (current_facing_dir == EDirection::LEFT) new_facing_dir = EDirection::BACK;
+				else if (current_facing_dir == EDirection::BACK) new_facing_dir = EDirection::RIGHT;
+				else new_facing_dir = EDirection::FORWARD;
+
+				new_building_side = (new_facing_dir == EDirection::FORWARD || new_facing_dir == EDirection::BACK) ? EDirection::RIGHT : EDirection::FORWARD;
+
+				if (current_facing_dir == EDirection::FORWARD) { new_x += (current_building_side == EDirection::RIGHT ? 0 : -1); }
+				else if (current_facing_dir == EDirection::BACK) { new_x += (current_building_side == EDirection::RIGHT ? 1 : 0); new_y -= 1; }
+				else if (current_facing_dir == EDirection::LEFT) { new_x -= 1; new_y += (current_building_side == EDirection::FORWARD ? 0 : -1); }
+				else { new_y += (current_building_side == EDirection::FORWARD ? 1 : 0); }
+			}
+			else
+			{
+				if (current_facing_dir == EDirection::FORWARD) new_facing_dir = EDirection::RIGHT;
+				else if (current_facing_dir == EDirection::BACK) new_facing_dir = EDirection::LEFT;
+				else if (current_facing_dir == EDirection::LEFT) new_facing_dir = EDirection::FORWARD;
+				else new_facing_dir = EDirection::BACK;
+
+				new_building_side = (new_facing_dir == EDirection::FORWARD || new_facing_dir == EDirection::BACK) ? EDirection::RIGHT : EDirection::FORWARD;
+
+				if (current_facing_dir == EDirection::FORWARD) { new_x += (current_building_side == EDirection::RIGHT ? 1 : 0); }
+				else if (current_facing_dir == EDirection::BACK) { new_x += (current_building_side == EDirection::RIGHT ? 0 : -1); new_y -= 1; }
+				else if (current_facing_dir == EDirection::LEFT) { new_x -= 1; new_y += (current_building_side == EDirection::FORWARD ? 1 : 0); }
+				else { new_y += (current_building_side == EDirection::FORWARD ? 0 : -1); }
+			}
+
+			if (new_x == -1 && new_y == -1)
+				return move;
+
+			if (new_x == -1)
+			{
+				new_x = 0;
+				new_building_side = EDirection::LEFT;
+			}
+			else if (new_y == -1)
+			{
+				new_y = 0;
+				new_building_side = EDirection::BACK;
+			}
+
+			if (new_x < 0 || new_y < 0 || new_x >= inGridSize || new_y >= inGridSize)
+				return move;
+
+			move.mFacingDirection = new_facing_dir;
+			move.mBuildingSide = new_building_side;
+			move.mX = new_x;
+			move.mY = new_y;
+			move.mIsLegal = true;
+			return move;
+		}
+
+		constexpr bool MatchesBranchLogic(const int inGridSize, const EDirection inFacingDirection)
+		{
+			for (int y = 0; y < inGridSize; ++y)
+			{
+				for (int x = 0; x < inGridSize; ++x)
+				{
+					const std::uint8_t boundary_class = GetBoundaryClass(x, y, inGridSize);
+					for (int side_i = 0; side_i < NumDirections; ++side_i)
+					{
+						const EDirection building_side = static_cast<EDirection>(side_i);
+						for (int turn_i = 0; turn_i < NumDirections; ++turn_i)
+						{
+							const EDirection turn = static_cast<EDirection>(turn_i);
+							const FBranchMove expected = BranchMove(inGridSize, x, y, inFacingDirection, building_side, turn);
+							const FStreetMove& move = GetStreetMove(boundary_class, inFacingDirection, building_side, turn);
+							if (move.mIsLegal != expected.mIsLegal)
+								return false;
+							if (((GetLegalTurns(boundary_class, inFacingDirection, building_side) & ToMask(turn)) != 0) != expected.mIsLegal)
+								return false;
+							if (!expected.mIsLegal)
+								continue;
+							if (move.mFacingDirection != expected.mFacingDirection || move.mBuildingSide != expected.mBuildingSide ||
+								x + move.mStepX != expected.mX || y + move.mStepY != expected.mY)
+								return false;
+						}
+					}
+				}
+			}
+			return true;
+		}
+
+		constexpr bool MatchesBranchLogic(const int inGridSize)
+		{
+			return MatchesBranchLogic(inGridSize, EDirection::BACK) && MatchesBranchLogic(inGridSize, EDirection::FORWARD) &&
+				MatchesBranchLogic(inGridSize, EDirection::LEFT) && MatchesBranchLogic(inGridSize, EDirection::RIGHT);
+		}
+	}
+
+	static_assert(MatchesBranchLogic(1), "Street move table does not match the branch logic on a 1x1 grid");
+	static_assert(MatchesBranchLogic(2), "Street move table does not match the branch logic on a 2x2 grid");
+	static_assert(MatchesBranchLogic(3), "Street move table does not match the branch logic on a 3x3 grid");
+	static_assert(MatchesBranchLogic(6, EDirection::BACK), "Street move table does not match the branch logic on a 6x6 grid");
+	static_assert(MatchesBranchLogic(6, EDirection::FORWARD), "Street move table does not match the branch logic on a 6x6 grid");
+	static_assert(MatchesBranchLogic(6, EDirection::LEFT), "Street move table does not match the branch logic on a 6x6 grid");
+	static_assert(MatchesBranchLogic(6, EDirection::RIGHT), "Street move table does not match the branch logic on a 6x6 grid");
+}